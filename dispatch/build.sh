@@ -0,0 +1,28 @@
+# compile: chmod +x build.sh
+# run: ./build.sh xxxx.cpp   (a program using DispatchFilter, e.g. ../test/dispatch.cpp)
+#
+# Every instruction set gets its own object with matching target flags. The program itself and
+# instrset_detect.cpp are built for the baseline, so never add -march=native here.
+
+set -euo pipefail
+
+if [ "$#" -ne 1 ]; then
+  echo "Usage: $0 <source.cpp>"
+  exit 1
+fi
+
+SRC="$1"
+DIR="$(cd "$(dirname "$0")" && pwd)"
+OBJ="/tmp/dispatch_obj"
+BIN="/tmp/$(basename "${SRC%.cpp}")"
+FLAGS="-std=c++20 -O2 -ffast-math"
+
+mkdir -p "$OBJ"
+
+clang++ $FLAGS -msse2 -c "$DIR/filter_sse.cpp" -o "$OBJ/filter_sse.o"
+clang++ $FLAGS -mavx2 -mfma -c "$DIR/filter_avx2.cpp" -o "$OBJ/filter_avx2.o"
+clang++ $FLAGS -mavx512f -mfma -c "$DIR/filter_avx512.cpp" -o "$OBJ/filter_avx512.o"
+clang++ $FLAGS -c "$DIR/../src/vcl/instrset_detect.cpp" -o "$OBJ/instrset_detect.o"
+
+clang++ $FLAGS -lpthread "$SRC" "$OBJ"/*.o -o "$BIN"
+exec "$BIN"
@@ -0,0 +1,11 @@
+#ifndef DISPATCH_CONFIGS_H
+#define DISPATCH_CONFIGS_H 1
+
+// (M,N) pairs compiled into every instruction-set translation unit. DispatchFilter<M,N> links only
+// for pairs listed here; N must be a multiple of 16 (the Vec16f lane count).
+#define FILTER_DISPATCH_CONFIGS(X) \
+    X(1,16) X(2,16) X(4,16) X(8,16) \
+    X(1,32) X(2,32) X(4,32) X(8,32) \
+    X(4,64) X(8,64)
+
+#endif
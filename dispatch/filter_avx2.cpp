@@ -0,0 +1,9 @@
+// Filter<Vec8f,M,N> instantiations, compiled with -mavx2 -mfma (see build.sh)
+
+#define VCL_NAMESPACE vcl_avx2
+#include "../src/vcl/vectorclass.h"
+using namespace vcl_avx2;
+
+#define DISPATCH_ISA avx2
+#define DISPATCH_V Vec8f
+#include "filter_isa.h"
@@ -0,0 +1,9 @@
+// Filter<Vec16f,M,N> instantiations, compiled with -mavx512f -mfma (see build.sh)
+
+#define VCL_NAMESPACE vcl_avx512
+#include "../src/vcl/vectorclass.h"
+using namespace vcl_avx512;
+
+#define DISPATCH_ISA avx512
+#define DISPATCH_V Vec16f
+#include "filter_isa.h"
@@ -0,0 +1,56 @@
+// Body shared by filter_{sse,avx2,avx512}.cpp, included once per translation unit after
+//   DISPATCH_ISA  the factory suffix (sse, avx2, avx512)
+//   DISPATCH_V    the vector type (Vec4f, Vec8f, Vec16f)
+// and after VCL has been put in its own VCL_NAMESPACE. Filter<V,M,N> is then a different type in every
+// translation unit, so instantiations built with different target flags cannot be merged by the linker.
+
+#if !defined(DISPATCH_ISA) || !defined(DISPATCH_V)
+#error "define DISPATCH_ISA and DISPATCH_V before including filter_isa.h"
+#endif
+
+#include "../include/filter.h"
+#include "../include/dispatch.h"
+#include "configs.h"
+
+#define DISPATCH_CAT_(a,b) a##b
+#define DISPATCH_CAT(a,b) DISPATCH_CAT_(a,b)
+#define DISPATCH_STR_(a) #a
+#define DISPATCH_STR(a) DISPATCH_STR_(a)
+
+
+template<typename V,size_t M,size_t N> class FilterKernelV: public FilterKernel<M>{
+
+    using State = typename FilterKernel<M>::State;
+
+    private:
+
+        Filter<V,M,N> _F;
+
+    public:
+
+        FilterKernelV(const float (&coefs)[M][5], const float (&inits)[M][4]): _F(coefs, inits){};
+
+        float* operator()(const float* first, const float* last, float* d_first) override { return _F(first, last, d_first);};
+
+        State state() override { return _F.state();};
+
+        void restore(const State& s) override { _F.restore(s);};
+
+        const char* isa() const override { return DISPATCH_STR(DISPATCH_ISA);};
+};
+
+
+namespace dispatch{
+
+    template<size_t M,size_t N>
+    std::unique_ptr<FilterKernel<M>> DISPATCH_CAT(make_,DISPATCH_ISA)(const float (&coefs)[M][5], const float (&inits)[M][4]){
+
+        return std::make_unique<FilterKernelV<DISPATCH_V,M,N>>(coefs, inits);
+    }
+}
+
+
+#define DISPATCH_INSTANTIATE(M,N) \
+    template std::unique_ptr<FilterKernel<M>> dispatch::DISPATCH_CAT(make_,DISPATCH_ISA)<M,N>(const float (&)[M][5], const float (&)[M][4]);
+
+FILTER_DISPATCH_CONFIGS(DISPATCH_INSTANTIATE)
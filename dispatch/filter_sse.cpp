@@ -0,0 +1,9 @@
+// Filter<Vec4f,M,N> instantiations, compiled with -msse2 (see build.sh)
+
+#define VCL_NAMESPACE vcl_sse
+#include "../src/vcl/vectorclass.h"
+using namespace vcl_sse;
+
+#define DISPATCH_ISA sse
+#define DISPATCH_V Vec4f
+#include "filter_isa.h"
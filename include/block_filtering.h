@@ -4,6 +4,8 @@
 #include "../src/vcl/vectorclass.h"
 #include <array>
 #include "shift_reg.h"
+#include "lanes.h"
+#include "ph_decompos.h" // RecurDoublingOrderOne
 
 
 template<typename V> class BlockFiltering{
@@ -17,7 +19,8 @@ template<typename V> class BlockFiltering{
 
         V _p2, _p1, _h2, _h1;
 
-        std::array<V,L> _H;
+        // block filtering matrix for x
+        Toeplitz<V> _H;
 
         Shift<V> _PS, _HS;
 
@@ -56,6 +59,16 @@ template<typename V> class BlockFiltering{
             return y; 
         };
 
+        inline void reset(const T xi1,const T xi2,const T yi1,const T yi2){
+
+            _PS.shift(xi2);
+            _PS.shift(xi1);
+            _HS.shift(yi2);
+            _HS.shift(yi1);
+        };
+
+        inline std::array<T,4> state(){ return {_PS[-1],_PS[-2],_HS[-1],_HS[-2]};};
+
 
         inline void impulse_response(){
         
@@ -86,41 +99,57 @@ template<typename V> class BlockFiltering{
 
         inline void H_factor(){
 
-            V tmp={0};
+            _H = Toeplitz<V>(blend_lanes<shift_in>(_h1+_p1, 1));
+        };
+
+};
 
-            // SSE
-            if constexpr (L == 4){
 
-                tmp = blend4<4,0,1,2>(_h1+_p1, 1);
+// First order, one vector of L samples: the FIR part from the input shifted by one lane, then the recursion as a
+// scalar prefix scan across the lanes, 2 + log2(L) FMAs instead of an L x L matrix product.
+template<typename V> class BlockFilteringOrderOne{
 
-                for (int l=0;l<L;l++){
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
 
-                    _H[l] = tmp;
-                    tmp = permute4<-1,0,1,2>(tmp);
-                }
-            }
+    private:
 
-            // AVX2
-            if constexpr (L == 8){ 
-                tmp = blend8<8,0,1,2,3,4,5,6>(_h1+_p1, 1);
+        T _b1; 
 
-                for (auto l=0; l<L; l++){
-                    _H[l] = tmp;
-                    tmp = permute8<-1,0,1,2,3,4,5,6>(tmp);
-                }
-            }
+        RecurDoublingOrderOne<V> _RD;
 
-            // AVX512
-            if constexpr (L == 16){ 
-                tmp = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(_h1+_p1, 1);
+        Shift<V> _PS, _HS;
 
-                for (auto l=0; l<L; l++){
-                    _H[l] = tmp;
-                    tmp = permute16<-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(tmp);
-                }
-            }
+    public:
+
+        BlockFilteringOrderOne(){};
+
+        BlockFilteringOrderOne(const T b1,const T a1,const T xi1=0,const T yi1=0): _b1(b1), _RD(a1){
+
+            _PS.shift(xi1);
+            _HS.shift(yi1);
+        };
+
+        inline V operator()(const V x){
+
+            V y = mul_add(blend_lanes<shift_in>(x, _PS[-1]), _b1, x);
+
+            y = _RD.scan(y, _HS[-1]);
+
+            _PS.shift(x);
+            _HS.shift(y);
+
+            return y; 
+        };
+
+        inline void reset(const T xi1,const T yi1){
+
+            _PS.shift(xi1);
+            _HS.shift(yi1);
         };
 
+        inline std::array<T,2> state(){ return {_PS[-1],_HS[-1]};};
+
 };
 
 
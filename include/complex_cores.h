@@ -0,0 +1,422 @@
+#ifndef COMPLEX_CORES_H
+#define COMPLEX_CORES_H 1
+
+#include "../src/vcl/vectorclass.h"
+#include <array>
+#include <complex>
+#include <span>
+#include <bit>  // c++20
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include "lanes.h"
+#include "permute.h"
+
+
+// Complex signals as interleaved (re,im) floats. A complex lane is a pair of float lanes and moves as one lane
+// of the double vector of the same width (Vec8f <-> Vec4d, Vec16f <-> Vec8d), so the lane permutes of lanes.h
+// and the transposes of permute.h apply unchanged.
+namespace cplx{
+
+    template<typename V> using Wide = decltype(reinterpret_d(std::declval<V>()));
+
+    template<int (*idx)(int,int,int), int s=0, typename V>
+    __attribute__((always_inline))
+    inline V permute_complex(const V a){ return reinterpret_f(permute_lanes<idx,s>(reinterpret_d(a)));};
+
+    // complex lane 0 of b, then the lanes of a shifted up by one
+    template<typename V>
+    __attribute__((always_inline))
+    inline V shift_in(const V a, const V b){ return reinterpret_f(blend_lanes<::shift_in>(reinterpret_d(a), reinterpret_d(b)));};
+
+    template<typename V>
+    __attribute__((always_inline))
+    inline V broadcast(const std::complex<float> z){ return reinterpret_f(Wide<V>(std::bit_cast<double>(z)));};
+
+    template<typename V>
+    __attribute__((always_inline))
+    inline std::complex<float> extract(const V a, const int c){ return std::bit_cast<std::complex<float>>(reinterpret_d(a)[c]);};
+
+    // a complex factor per complex lane: r = (re,re), i = (-im,im)
+    template<typename V> struct Factor{ V r, i; };
+
+    template<typename V>
+    inline Factor<V> factor(const std::complex<double>* z){
+
+        constexpr int L = V::size();
+        float r[L], i[L];
+
+        for (int l=0; l<L/2; l++){
+
+            r[2*l] = r[2*l+1] = z[l].real();
+            i[2*l] = -z[l].imag();
+            i[2*l+1] = z[l].imag();
+        }
+
+        Factor<V> f;
+        f.r.load(r);
+        f.i.load(i);
+        return f;
+    };
+
+    // acc + f*x, two FMAs and one permute
+    template<typename V>
+    __attribute__((always_inline))
+    inline V mul_add(const V x, const Factor<V>& f, const V acc){
+        return ::mul_add(permute_lanes<pair_swap>(x), f.i, ::mul_add(x, f.r, acc));
+    };
+}
+
+
+// Complex section of order K (1 or 2) over interleaved complex floats,
+// y[n] = x[n] + sum_k bk*x[n-k] + sum_k ak*y[n-k] with complex bk, ak.
+// The multi-block path is PH/RD on blocks transposed by complex lanes: FIR and particular solution run down the
+// lanes, the lanes are joined by recursive doubling with the complex K x K companion matrix, as RecurDoublingOrderK.
+// A complex multiply-add is two FMAs and a re/im swap, against the real 2K-th order system otherwise needed.
+template<typename V,size_t N,size_t K> class ComplexIirCore{
+
+    using T = decltype(std::declval<V>().extract(0));
+    using C = std::complex<T>;
+    using Cd = std::complex<double>;
+    using W = cplx::Wide<V>;
+    using F = cplx::Factor<V>;
+
+    static_assert(sizeof(T) == 4, "interleaved complex float");
+    static_assert(K >= 1 && N >= K);
+
+    constexpr static int L = V::size();
+    constexpr static int Lc = L/2;  // complex lanes
+    constexpr static int S = std::bit_width(unsigned(Lc))-1; // recursion steps
+
+    // _rd[s][i][j]: [C 0 ... 0] for s = 0, C^1..C^(2^(s-1)) in the complex lanes with bit s-1 set
+    using RD = std::array<std::array<std::array<F,K>,K>,S+1>;
+
+    private:
+
+        std::array<F,K> _b, _a;
+
+        // contribution of y[-1-j] to y[n] within a lane of a block
+        std::array<std::array<C,N>,K> _h;
+
+        // companion powers across the lanes, of a block of N (multi-block) and of one sample (block path)
+        RD _rdN, _rd1;
+
+        C _bs[K], _as[K];
+
+        // x[-1..-K], y[-1..-K], shared by all paths
+        std::array<C,K> _xi, _yi;
+
+        V _sgn;
+
+        // homogeneous responses over a segment of length n: companion matrix Cm, h[j][0..n-1] if given
+        inline static void _companion(const Cd (&a)[K], const size_t n, Cd (&Cm)[K][K], Cd* h = nullptr){
+
+            for (size_t j=0; j<K; j++){
+
+                std::vector<Cd> g(K+n, 0);
+                g[K-1-j] = 1;
+
+                for (size_t m=0; m<n; m++){
+
+                    for (size_t k=1; k<=K; k++) g[K+m] += a[k-1]*g[K+m-k];
+                    if (h) h[j*N + m] = g[K+m];
+                }
+
+                for (size_t i=0; i<K; i++) Cm[i][j] = g[K+n-1-i];
+            }
+        };
+
+        inline static void _rd_factors(const Cd (&Cm)[K][K], RD& rd){
+
+            Cd P[K][K], Q[K][K], p[K][K][Lc];
+
+            for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++) P[i][j] = Cm[i][j];
+
+            // C^1 .. C^Lc
+            for (int l=0; l<Lc; l++){
+
+                for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++) p[i][j][l] = P[i][j];
+
+                for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++){
+
+                    Q[i][j] = 0;
+                    for (size_t k=0; k<K; k++) Q[i][j] += Cm[i][k]*P[k][j];
+                }
+
+                for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++) P[i][j] = Q[i][j];
+            }
+
+            for (int s=0; s<=S; s++) for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++){
+
+                Cd z[Lc];
+
+                for (int l=0; l<Lc; l++){
+
+                    const int idx = rd_factor(Lc, s, l);
+                    z[l] = idx < 0 ? Cd(0) : p[i][j][idx];
+                }
+
+                rd[s][i][j] = cplx::factor<V>(z);
+            }
+        };
+
+        template<int s>
+        __attribute__((always_inline))
+        inline static void _recursion(std::array<V,K>& e, const RD& rd){
+
+            std::array<V,K> t;
+
+            #pragma unroll
+            for (size_t j=0; j<K; j++) t[j] = cplx::permute_complex<rd_broadcast,s>(e[j]);
+
+            #pragma unroll
+            for (size_t i=0; i<K; i++)
+                #pragma unroll
+                for (size_t j=0; j<K; j++) e[i] = cplx::mul_add(t[j], rd[s][i][j], e[i]);
+        }
+
+        // e = particular solution at the lane ends on entry, the true ends on return
+        __attribute__((always_inline))
+        inline void _scan(std::array<V,K>& e, const RD& rd){
+
+            #pragma unroll
+            for (size_t i=0; i<K; i++)
+                #pragma unroll
+                for (size_t j=0; j<K; j++) e[i] = cplx::mul_add(cplx::broadcast<V>(_yi[j]), rd[0][i][j], e[i]);
+
+            [&]<int... s>(std::integer_sequence<int,s...>){
+
+                (_recursion<s+1>(e, rd), ...);
+
+            }(std::make_integer_sequence<int,S>{});
+        }
+
+        // blocks of N vectors to and from the transposed layout, complex lane c holding samples c*N .. c*N+N-1
+        __attribute__((always_inline))
+        inline static std::array<V,N> _in(const std::array<V,N>& x){
+
+            std::array<W,N> w;
+            std::array<V,N> y;
+
+            for (size_t n=0; n<N; n++) w[n] = reinterpret_d(x[n]);
+            w = permuteV(w);
+            for (size_t n=0; n<N; n++) y[n] = reinterpret_f(w[n]);
+
+            return y;
+        };
+
+        __attribute__((always_inline))
+        inline static std::array<V,N> _out(const std::array<V,N>& y_T){
+
+            std::array<W,N> w;
+            std::array<V,N> y;
+
+            for (size_t n=0; n<N; n++) w[n] = reinterpret_d(y_T[n]);
+            w = depermuteV(w);
+            for (size_t n=0; n<N; n++) y[n] = reinterpret_f(w[n]);
+
+            return y;
+        };
+
+    public:
+
+        ComplexIirCore(){};
+
+        ComplexIirCore(const C (&b)[K], const C (&a)[K], const std::array<C,K>& xi = {}, const std::array<C,K>& yi = {}): _xi(xi), _yi(yi){
+
+            Cd ad[K], Cm[K][K], h[K*N];
+
+            for (size_t k=0; k<K; k++){
+
+                Cd bk = b[k];
+                ad[k] = a[k];
+
+                _b[k] = cplx::factor<V>(std::vector<Cd>(Lc, bk).data());
+                _a[k] = cplx::factor<V>(std::vector<Cd>(Lc, ad[k]).data());
+                _bs[k] = b[k];
+                _as[k] = a[k];
+            }
+
+            _companion(ad, N, Cm, h);
+            _rd_factors(Cm, _rdN);
+
+            for (size_t j=0; j<K; j++) for (size_t n=0; n<N; n++) _h[j][n] = C(h[j*N + n]);
+
+            _companion(ad, 1, Cm);
+            _rd_factors(Cm, _rd1);
+
+            T sgn[L];
+            for (int l=0; l<L; l++) sgn[l] = (l & 1) ? 1 : -1;
+            _sgn.load(sgn);
+        };
+
+        __attribute__((always_inline))
+        inline C operator()(const C x){
+
+            C y = x;
+
+            for (size_t k=0; k<K; k++) y += _bs[k]*_xi[k] + _as[k]*_yi[k];
+
+            for (size_t k=K-1; k>0; k--){ _xi[k] = _xi[k-1]; _yi[k] = _yi[k-1];}
+            _xi[0] = x;
+            _yi[0] = y;
+
+            return y;
+        }
+
+        // Lc consecutive samples
+        __attribute__((always_inline))
+        inline V operator()(const V x){
+
+            V y = x, s = x;
+
+            #pragma unroll
+            for (size_t k=1; k<=K; k++){
+
+                s = cplx::shift_in(s, cplx::broadcast<V>(_xi[k-1]));
+                y = cplx::mul_add(s, _b[k-1], y);
+            }
+
+            std::array<C,K> xi;
+            for (size_t k=0; k<K; k++) xi[k] = int(k) < Lc ? cplx::extract(x, Lc-1-k) : _xi[k-Lc];
+            _xi = xi;
+
+            // complex lane l of e[i] ends up holding y[l-i]
+            std::array<V,K> e;
+            e.fill(V(0));
+            e[0] = y;
+
+            _scan(e, _rd1);
+
+            for (size_t k=0; k<K; k++) _yi[k] = cplx::extract(e[k], Lc-1);
+
+            return e[0];
+        }
+
+        // in place on a transposed block
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+
+            // FIR, from the last block down; x[n-k] of the first blocks comes from the previous lane
+            std::array<V,K> xvi;
+
+            #pragma unroll
+            for (size_t m=0; m<K; m++){
+
+                xvi[m] = cplx::shift_in(x[N-1-m], cplx::broadcast<V>(_xi[m]));
+                _xi[m] = cplx::extract(x[N-1-m], Lc-1);
+            }
+
+            #pragma unroll
+            for (size_t n=N; n-- > 0; )
+                #pragma unroll
+                for (size_t k=1; k<=K; k++) x[n] = cplx::mul_add(n >= k ? x[n-k] : xvi[k-n-1], _b[k-1], x[n]);
+
+            // particular solution, every lane from zero
+            #pragma unroll
+            for (size_t n=1; n<N; n++)
+                #pragma unroll
+                for (size_t k=1; k<=std::min(n,K); k++) x[n] = cplx::mul_add(x[n-k], _a[k-1], x[n]);
+
+            // homogeneous solution: the lane ends by recursive doubling, then y[-1-j] of each lane into the others
+            std::array<V,K> e, yp, yq;
+
+            #pragma unroll
+            for (size_t i=0; i<K; i++) e[i] = x[N-1-i];
+
+            _scan(e, _rdN);
+
+            #pragma unroll
+            for (size_t j=0; j<K; j++){
+
+                yp[j] = cplx::shift_in(e[j], cplx::broadcast<V>(_yi[j]));
+                yq[j] = permute_lanes<pair_swap>(yp[j])*_sgn;
+                _yi[j] = cplx::extract(e[j], Lc-1);
+            }
+
+            #pragma unroll
+            for (size_t n=0; n+K<N; n++)
+                #pragma unroll
+                for (size_t j=0; j<K; j++){
+
+                    x[n] = mul_add(yp[j], _h[j][n].real(), x[n]);
+                    x[n] = mul_add(yq[j], _h[j][n].imag(), x[n]);
+                }
+
+            #pragma unroll
+            for (size_t i=0; i<K; i++) x[N-1-i] = e[i];
+        }
+
+        // streaming over std::complex<float>: chunks may have any length, the recursion carries over between calls
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
+
+            std::array<V,N> x;
+
+            // multi-block: N vectors of Lc samples per step
+            while (last - first >= static_cast<std::ptrdiff_t>(N*Lc)){
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n].load(reinterpret_cast<const T*>(&*(first + n*Lc)));
+
+                x = _in(x);
+                apply(x);
+                x = _out(x);
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n].store(reinterpret_cast<T*>(&*(d_first + n*Lc)));
+
+                first += N*Lc;
+                d_first += N*Lc;
+            }
+
+            // remainder: single vectors of Lc samples
+            V xv;
+
+            while (last - first >= Lc){
+
+                xv.load(reinterpret_cast<const T*>(&*first));
+                (*this)(xv).store(reinterpret_cast<T*>(&*d_first));
+
+                first += Lc;
+                d_first += Lc;
+            }
+
+            // remainder: less than Lc samples
+            while (first != last){
+
+                *d_first = (*this)(static_cast<C>(*first));
+
+                first += 1;
+                d_first += 1;
+            }
+
+            return d_first;
+        };
+
+        inline void process(std::span<const C> chunk, std::span<C> out){ (*this)(chunk.begin(), chunk.end(), out.begin());};
+
+        inline void process(std::span<C> chunk){ (*this)(chunk.begin(), chunk.end(), chunk.begin());};
+
+        // {xi1..xiK, yi1..yiK}
+        inline std::array<C,2*K> state() const {
+
+            std::array<C,2*K> s;
+            for (size_t k=0; k<K; k++){ s[k] = _xi[k]; s[K+k] = _yi[k];}
+            return s;
+        };
+
+        inline void reset(const std::array<C,2*K>& s){
+            for (size_t k=0; k<K; k++){ _xi[k] = s[k]; _yi[k] = s[K+k];}
+        };
+
+};
+
+
+// complex resonators: one pole, and the second order with two independent complex poles
+template<typename V,size_t N> using ComplexIirCoreOrderOne = ComplexIirCore<V,N,1>;
+
+template<typename V,size_t N> using ComplexIirCoreOrderTwo = ComplexIirCore<V,N,2>;
+
+
+#endif // header guard
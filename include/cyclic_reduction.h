@@ -4,70 +4,87 @@
 #include "../src/vcl/vectorclass.h"
 #include <array>
 #include "shift_reg.h"
+#include "lanes.h"
+#include "ph_decompos.h"
 #include <bit>  // c++20
 
 
+// N = 2^R Q with Q odd: R rounds of odd-even reduction leave Q unknowns per lane. For Q = 1 the top
+// block is solved by block filtering across the lanes, otherwise as a recursion of Q steps by PH/RD.
 template<typename V,size_t N> class CyclicReduction{
 
+    static_assert(N >= 2, "cyclic reduction needs at least two blocks");
+
     using T = decltype(std::declval<V>().extract(0));
     constexpr static int L = V::size(); 
-    constexpr static int R = std::bit_width(N)-1; 
+    constexpr static int R = std::countr_zero(N); 
+    constexpr static size_t Q = N >> R;
+
+    // BW rounds after the top block, the first one is special for Q = 1
+    constexpr static int B = Q == 1 ? R-1 : R;
+
+    // Gaussian elimination factors, only needed while the constructor precomputes the members below
+    struct Factors{ T f[R+1],e[R+1],fde[R+1],d[R+1],c[R+1],h[R+1],g[R+1]; };
+
+    struct None{};
 
     private:
 
-        T _a2, _a1;
+        // members are laid out in the order operator() reads them, FW then BW
 
-        T _f[R+1],_e[R+1],_fde[R+1];    
-        T _d[R+1],_c[R+1];
-        T _h[R+1],_g[R+1];
+        // in FW, elimination factors f/e and e of each round
+        std::array<T,R> _fde,_e;
 
-        // block filtering matrix for x
-        std::array<V,L> _H;
+        // block filtering matrix for x, Q = 1
+        [[no_unique_address]] std::conditional_t<Q == 1, Toeplitz<V>, None> _H;
 
-        // block filtering vector for yi2 and yi1
+        // block filtering vector for yi2 and yi1, for Q > 1 in lane 0 only, with _f1 for yi1 in the second block
         V _h2,_h1;
+        [[no_unique_address]] std::conditional_t<(Q > 1), V, None> _f1;
 
-        // in BW, filtering the top block 
-        std::array<V,R> _hb2_0,_hb1_0;
+        // recursion of the top blocks, Q > 1
+        [[no_unique_address]] std::conditional_t<(Q > 1), PartSolutionV<V,Q>, None> _PSV;
+        [[no_unique_address]] std::conditional_t<(Q > 1), HomoSolutionV<V,Q>, None> _HSV;
 
-        // in BW, filtering the rest block (excluding the first round)
-        std::array<V,R-1> _hb2,_hb1;
+        // in BW, filtering the top block: lane 0 and the other lanes, blended where they are read
+        std::array<T,R> _hb2_0,_hb2_r,_hb1_0,_hb1_r;
+
+        // in BW, filtering the rest block (excluding the first round for Q = 1), the same in every lane
+        std::array<T,B> _hb2,_hb1;
 
         Shift<V> _S;
 
+        __attribute__((always_inline))
+        inline static V _hb_0(const std::array<T,R>& lane0, const std::array<T,R>& rest, const int n){ 
+            return blend_lanes<first_in>(V(rest[n]), lane0[n]);
+        };
+
     public:
 
         CyclicReduction(){};
 
         __attribute__((always_inline))
-        CyclicReduction(const T a1,const T a2,const T yi1=0,const T yi2=0): _a1(a1),_a2(a2){
+        CyclicReduction(const T a1,const T a2,const T yi1=0,const T yi2=0){
 
-            gaussian_elimination_factors();
-            block_filtering_factors();    
-            backward_factor();
+            Factors F = gaussian_elimination_factors(a1,a2);
+            block_filtering_factors(F);    
+            backward_factor(F);
             _S.shift(yi2);
             _S.shift(yi1);
         };
 
 
+        // in place, round by round
         template<int round> 
         __attribute__((always_inline))
-        inline std::array<V,N> forward(std::array<V,N> &x){
+        inline void forward(std::array<V,N> &x){
 
             if constexpr (round < R) {
 
                 constexpr int K = 1 << round;
                 constexpr int P = (N / K) >> 1;
 
-                V tmp;
-                if constexpr (L == 4) 
-                    tmp = permute4<-1,0,1,2>(x[N-1]);
-
-                if constexpr (L == 8) 
-                    tmp = permute8<-1,0,1,2,3,4,5,6>(x[N-1]);
-
-                if constexpr (L == 16)
-                    tmp = permute16<-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(x[N-1]);
+                V tmp = permute_lanes<shift_up>(x[N-1]);
 
                 x[K-1] = mul_add(-_fde[round], tmp, x[K-1]);
 
@@ -79,50 +96,60 @@ template<typename V,size_t N> class CyclicReduction{
                 for (int n = 0; n < P; ++n) 
                     x[2*K*n + 2*K - 1] = mul_add(-_e[round],x[2*K*n + (K-1)],x[2*K*n + 2*K - 1]);
                 
-                return forward<round+1>(x);
+                forward<round+1>(x);
             } 
-            else
-                return x;
         }
 
+        // in place: every y[i] starts from the FW result in its own slot, all other reads are y's already solved
         __attribute__((always_inline))
-        inline std::array<V,N> backward(const std::array<V,N>& x){
+        inline void backward(std::array<V,N>& y){
 
-            std::array<V,N> y{0};
+            V yvi1;
 
-            for (auto l=0; l<L; l++) 
-                y[N-1] = mul_add(_H[l],x[N-1][l],y[N-1]);
+            if constexpr (Q == 1){
 
-            y[N-1] = mul_add(_h2,-_S[-2],y[N-1]);
-            y[N-1] = mul_add(_h1,-_S[-1],y[N-1]);
-            
-            
-            V yvi2,yvi1,tmp1,tmp2;
+                V top(0);
 
-            if constexpr (L == 4){
+                for (auto l=0; l<L; l++) 
+                    top = mul_add(_H[l],y[N-1][l],top);
+
+                y[N-1] = mul_add(_h2,-_S[-2],top);
+                y[N-1] = mul_add(_h1,-_S[-1],y[N-1]);
+                
+                
+                V yvi2 = blend_lanes<shift_in>(y[N-1], _S[-2]);
+                yvi1 = blend_lanes<shift_in>(y[N-1], _S[-1]);
+                V tmp1 = permute_lanes<shift_up_dup>(yvi1);
 
-                yvi2 = blend4<4,0,1,2>(y[N-1],_S[-2]);
-                yvi1 = blend4<4,0,1,2>(y[N-1],_S[-1]);
-                tmp1 = permute4<0,0,1,2>(yvi1);
+                y[N/2-1] = mul_add(_hb_0(_hb2_0,_hb2_r,R-1),-yvi2,y[N/2-1]);
+                y[N/2-1] = mul_add(_hb_0(_hb1_0,_hb1_r,R-1),-tmp1,y[N/2-1]);
             }
-            else if constexpr (L == 8) {
+            else{
 
-                yvi2 = blend8<8,0,1,2,3,4,5,6>(y[N-1], _S[-2]);
-                yvi1 = blend8<8,0,1,2,3,4,5,6>(y[N-1], _S[-1]);
-                tmp1 = permute8<0,0,1,2,3,4,5,6>(yvi1);
+                constexpr size_t K = size_t(1) << R;
 
-            } else {
-                
-                yvi2 = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(y[N-1], _S[-2]);
-                yvi1 = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(y[N-1], _S[-1]); 
-                tmp1 = permute16<0,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(yvi1);
-            }
+                // the top blocks x[K-1], x[2K-1], ... form a second-order recursion over Q*L values,
+                // the initial values only enter its first two in lane 0
+                std::array<V,Q> t;
+
+                #pragma unroll
+                for (size_t q=0; q<Q; q++) t[q] = y[K*q + K-1];
+
+                t[0] = mul_add(_h2,-_S[-2],t[0]);
+                t[0] = mul_add(_h1,-_S[-1],t[0]);
+                t[1] = mul_add(_f1,-_S[-1],t[1]);
+
+                _HSV.reset(0,0);
+                t = _HSV(_PSV(t));
+
+                #pragma unroll
+                for (size_t q=0; q<Q; q++) y[K*q + K-1] = t[q];
 
-            y[N/2-1] = mul_add(_hb2_0[R-1],-yvi2,x[N/2-1]);
-            y[N/2-1] = mul_add(_hb1_0[R-1],-tmp1,y[N/2-1]);
+                yvi1 = blend_lanes<shift_in>(y[N-1], _S[-1]);
+            }
             
             #pragma unroll
-            for (int ro=R-2; ro>=0; ro--){
+            for (int ro=B-1; ro>=0; ro--){
 
                 int K = 1 << (ro+1);
                 const int P = N/K;
@@ -131,175 +158,253 @@ template<typename V,size_t N> class CyclicReduction{
                 for (int n=0; n<P; n++){
                     if (n == 0){
 
-                        if constexpr (L == 4)
-                            tmp2 = blend4<4,0,1,2>(y[N-K-1],_S[-2]);
-                        
-                        if constexpr (L == 8)    
-                            tmp2 = blend8<8,0,1,2,3,4,5,6>(y[N-K-1],_S[-2]);
-                        
-                        if constexpr (L == 16)    
-                            tmp2 = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(y[N-K-1],_S[-2]);
-                        
-                        y[K/2-1] = mul_add(_hb2_0[ro],-tmp2,x[K/2-1]);
-                        y[K/2-1] = mul_add(_hb1_0[ro],-yvi1,y[K/2-1]);
+                        V tmp2 = blend_lanes<shift_in>(y[N-K-1], _S[-2]);
+
+                        y[K/2-1] = mul_add(_hb_0(_hb2_0,_hb2_r,ro),-tmp2,y[K/2-1]);
+                        y[K/2-1] = mul_add(_hb_0(_hb1_0,_hb1_r,ro),-yvi1,y[K/2-1]);
                     }
                     else if (n == 1){
 
-                        y[3*K/2-1] = mul_add(_hb2[ro],-yvi1,x[3*K/2-1]);
+                        y[3*K/2-1] = mul_add(_hb2[ro],-yvi1,y[3*K/2-1]);
                         y[3*K/2-1] = mul_add(_hb1[ro],-y[K-1],y[3*K/2-1]);
                     }
                     else{
 
-                        y[K*n+K/2-1] = mul_add(_hb2[ro],-y[K*(n-1)-1],x[K*n+K/2-1]);
+                        y[K*n+K/2-1] = mul_add(_hb2[ro],-y[K*(n-1)-1],y[K*n+K/2-1]);
                         y[K*n+K/2-1] = mul_add(_hb1[ro],-y[K*n-1],y[K*n+K/2-1]);
                     }
                 }
             }
 
-            _S.shift(y[N-2][N-1]);
-            _S.shift(y[N-1][N-1]); 
-
-            return y;
+            _S.shift(y[N-2][L-1]);
+            _S.shift(y[N-1][L-1]);
         }
 
-        inline void gaussian_elimination_factors(){
+        inline Factors gaussian_elimination_factors(const T a1,const T a2){
+
+            Factors F;
 
-            _f[0] = -_a2;
-            _e[0] = -_a1;
-            _h[0] = _f[0];
-            _g[0] = _e[0];
-            _fde[0] = _f[0]/_e[0];
+            F.f[0] = -a2;
+            F.e[0] = -a1;
+            F.h[0] = F.f[0];
+            F.g[0] = F.e[0];
+            F.fde[0] = F.f[0]/F.e[0];
             
             for (int n=1;n<R+1;n++){
 
-                _d[n] = -_f[n-1]*_f[n-1]/_e[n-1];
-                _c[n] = _e[n-1] - _f[n-1]/_e[n-1];
-                _f[n] = -_e[n-1]*_d[n];
-                _e[n] = _f[n-1] - _e[n-1]*_c[n];
+                F.d[n] = -F.f[n-1]*F.f[n-1]/F.e[n-1];
+                F.c[n] = F.e[n-1] - F.f[n-1]/F.e[n-1];
+                F.f[n] = -F.e[n-1]*F.d[n];
+                F.e[n] = F.f[n-1] - F.e[n-1]*F.c[n];
                 
-                _h[n] = -_e[n-1]*_h[n-1];
-                _g[n] = _f[n-1] - _e[n-1]*_g[n-1];
+                F.h[n] = -F.e[n-1]*F.h[n-1];
+                F.g[n] = F.f[n-1] - F.e[n-1]*F.g[n-1];
 
-                _fde[n] = _f[n]/_e[n];
+                F.fde[n] = F.f[n]/F.e[n];
             }
-        }
 
-        inline void block_filtering_factors(){
+            for (int n=0;n<R;n++){
 
-            T h0[L]={0},h1[L]={0},h2[L]={0};
-            V _h0;
+                _fde[n] = F.fde[n];
+                _e[n] = F.e[n];
+            }
+
+            return F;
+        }
 
-            h0[0] = 1;
-            h0[1] = -_e[R];
+        inline void block_filtering_factors(const Factors& F){
 
-            for (int l=2;l<L;l++)
-                h0[l] = -_e[R]*h0[l-1] - _f[R]*h0[l-2];
+            if constexpr (Q > 1){
 
-                h2[0] = _h[R]*h0[0];
-                h1[0] = _g[R]*h0[0];
-            
-            for (int l = 1; l < L; ++l){
-                h2[l] = _h[R]*h0[l];
-                h1[l] = _g[R]*(h0[l] + _f[R]/_g[R]*h0[l-1]);
+                _h2 = blend_lanes<first_in>(V(0), F.h[R]);
+                _h1 = blend_lanes<first_in>(V(0), F.g[R]);
+                _f1 = blend_lanes<first_in>(V(0), F.f[R]);
+
+                _PSV = PartSolutionV<V,Q>(-F.e[R],-F.f[R]);
+                _HSV = HomoSolutionV<V,Q>(-F.e[R],-F.f[R]);
             }
+            else{
+
+                T h0[L]={0},h1[L]={0},h2[L]={0};
+                V _h0;
 
-            _h2.load(&h2[0]);
-            _h1.load(&h1[0]);
-            _h0.load(&h0[0]);
+                h0[0] = 1;
+                h0[1] = -F.e[R];
 
-            // AVX2
-            if constexpr (L == 8){ 
-                for (auto l=0; l<L; l++){
+                for (int l=2;l<L;l++)
+                    h0[l] = -F.e[R]*h0[l-1] - F.f[R]*h0[l-2];
 
-                    _H[l] = _h0;
-                    _h0 = permute8<-1,0,1,2,3,4,5,6>(_h0);
+                h2[0] = F.h[R]*h0[0];
+                h1[0] = F.g[R]*h0[0];
+                
+                for (int l = 1; l < L; ++l){
+                    h2[l] = F.h[R]*h0[l];
+                    h1[l] = F.g[R]*(h0[l] + F.f[R]/F.g[R]*h0[l-1]);
                 }
 
+                _h2.load(&h2[0]);
+                _h1.load(&h1[0]);
+                _h0.load(&h0[0]);
+
+                _H = Toeplitz<V>(_h0);
             }
+        }
+
+
+        inline void backward_factor(const Factors& F){
+
+            for (int n=R;n>=1;n--){
+
+                _hb2_0[n-1] = F.h[n-1];
+                _hb1_0[n-1] = F.g[n-1];
 
-            // SSE
-            if constexpr (L == 4){
-                for (int l=0;l<L;l++){
+                if (Q == 1 && n == R){
 
-                    _H[l] = _h0;
-                    _h0 = permute4<-1,0,1,2>(_h0);
+                    _hb2_r[n-1] = F.c[n];
+                    _hb1_r[n-1] = F.d[n];
                 }
-            }
-            
-            // AVX512
-            if constexpr (L == 16){ 
-                for (auto l=0; l<L; l++){
+                else{
+
+                    _hb2[n-1] = F.d[n]; 
+                    _hb1[n-1] = F.c[n];
 
-                    _H[l] = _h0;
-                    _h0 = permute16<-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(_h0);
+                    _hb2_r[n-1] = F.d[n];
+                    _hb1_r[n-1] = F.c[n];
                 }
             }
         }
 
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+            
+            forward<0>(x);
+            backward(x);
+        }
 
-        inline void backward_factor(){
+        __attribute__((always_inline))
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
+            
+            std::array<V,N> y = x;
+            apply(y);
 
-            T c[L],d[L];
-            V h2,h1;
+            return y;
+        }
 
-            for (int n=R;n>=1;n--){
+        inline void reset(const T yi1,const T yi2){ _S.shift(yi2); _S.shift(yi1);};
 
-                std::fill_n(c,L,_c[n]);
-                std::fill_n(d,L,_d[n]);
-                h2.load(&d[0]);
-                h1.load(&c[0]);
+        inline std::array<T,2> state(){ return {_S[-1],_S[-2]};};
+};
 
-                if (n == R){
-    
-                    if constexpr (L == 4){
 
-                        _hb2_0[n-1] = blend4<4,0,0,0>(h1,_h[n-1]); 
-                        _hb1_0[n-1] = blend4<4,0,0,0>(h2,_g[n-1]);
-                    }
-                    if constexpr (L == 8){
-        
-                        _hb2_0[n-1] = blend8<8,0,0,0,0,0,0,0>(h1,_h[n-1]);
-                        _hb1_0[n-1] = blend8<8,0,0,0,0,0,0,0>(h2,_g[n-1]);
-                    }
-        
-                    if constexpr (L == 16){
-        
-                        _hb2_0[n-1] = blend16<16,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0>(h1,_h[n-1]);
-                        _hb1_0[n-1] = blend16<16,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0>(h2,_g[n-1]);
-                    }
-                }
-                else{
+// First order, y[n] = v[n] + a1*y[n-1], on the transposed blocks. The bidiagonal system needs no elimination:
+// FW round r adds a1^(2^r) times the end of each segment of 2^r blocks to the end of the next one, BW fills
+// the midpoints in reverse. For N = 2^R Q the Q top blocks run sequentially, the lanes are joined by a scalar
+// prefix scan (RecurDoublingOrderOne). About 2N FMAs against 4N for the second order.
+template<typename V,size_t N> class CyclicReductionOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+    constexpr static int R = std::countr_zero(N); 
+    constexpr static size_t Q = N >> R;
+    constexpr static size_t K = size_t(1) << R;
 
-                    _hb2[n-1] = h2; 
-                    _hb1[n-1] = h1;
+    private:
 
-                    if constexpr (L == 4){
+        // a1^(2^r) of FW and BW round r
+        std::array<T,R> _p;
 
-                        _hb2_0[n-1] = blend4<4,0,0,0>(h2,_h[n-1]);
-                        _hb1_0[n-1] = blend4<4,0,0,0>(h1,_g[n-1]);
-                    }
+        // a1^K between the top blocks, a1^(K(q+1)) from the previous lane into top block q
+        T _pK;
+        std::array<T,Q> _t;
 
-                    if constexpr (L == 8){
+        // a1^N across the lanes
+        RecurDoublingOrderOne<V> _RD;
 
-                        _hb2_0[n-1] = blend8<8,0,0,0,0,0,0,0>(h2,_h[n-1]);
-                        _hb1_0[n-1] = blend8<8,0,0,0,0,0,0,0>(h1,_g[n-1]);
-                    }
+        Shift<V> _S;
 
-                    if constexpr (L == 16){
+    public:
 
-                        _hb2_0[n-1] = blend16<16,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0>(h2,_h[n-1]);
-                        _hb1_0[n-1] = blend16<16,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0>(h1,_g[n-1]);
-                    }
-                }
+        CyclicReductionOrderOne(){};
+
+        CyclicReductionOrderOne(const T a1,const T yi1=0){
+
+            T p = a1;
+
+            for (int r=0; r<R; r++){ _p[r] = p; p *= p;}
+
+            _pK = p;
+            _t[0] = p;
+            for (size_t q=1; q<Q; q++) _t[q] = _t[q-1]*p;
+
+            _RD = RecurDoublingOrderOne<V>(_t[Q-1]);
+            _S.shift(yi1);
+        };
+
+        template<int round> 
+        __attribute__((always_inline))
+        inline void forward(std::array<V,N>& x){
+
+            if constexpr (round < R) {
+
+                constexpr size_t k = size_t(1) << round;
+
+                #pragma unroll
+                for (size_t n=0; n<N/(2*k); n++) 
+                    x[2*k*n + 2*k-1] = mul_add(x[2*k*n + k-1], _p[round], x[2*k*n + 2*k-1]);
+
+                forward<round+1>(x);
+            } 
+        }
+
+        __attribute__((always_inline))
+        inline void backward(std::array<V,N>& y){
+
+            #pragma unroll
+            for (size_t q=1; q<Q; q++) y[K*q + K-1] = mul_add(y[K*q - 1], _pK, y[K*q + K-1]);
+
+            y[N-1] = _RD.scan(y[N-1], _S[-1]);
+
+            V yvi1 = blend_lanes<shift_in>(y[N-1], _S[-1]);
+
+            #pragma unroll
+            for (size_t q=0; q+1<Q; q++) y[K*q + K-1] = mul_add(yvi1, _t[q], y[K*q + K-1]);
+
+            #pragma unroll
+            for (int ro=R-1; ro>=0; ro--){
+
+                const size_t k = size_t(1) << ro;
+
+                y[k-1] = mul_add(yvi1, _p[ro], y[k-1]);
+
+                #pragma unroll
+                for (size_t n=1; n<N/(2*k); n++) 
+                    y[2*k*n + k-1] = mul_add(y[2*k*n - 1], _p[ro], y[2*k*n + k-1]);
             }
+
+            _S.shift(y[N-1][L-1]);
+        }
+
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+            
+            forward<0>(x);
+            backward(x);
         }
 
         __attribute__((always_inline))
-        inline std::array<V,N> operator()(std::array<V,N>& x){
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
             
-            return backward(forward<0>(x));
+            std::array<V,N> y = x;
+            apply(y);
+
+            return y;
         }
+
+        inline void reset(const T yi1){ _S.shift(yi1);};
+
+        inline T state(){ return _S[-1];};
 };
 
+
 #endif
 
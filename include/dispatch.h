@@ -0,0 +1,81 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H 1
+
+#include "../src/vcl/instrset.h"
+#include <array>
+#include <memory>
+#include <span>
+
+
+// Filter<V,M,N> over float behind an ISA-independent interface. The implementations live in
+// dispatch/filter_{sse,avx2,avx512}.cpp, each compiled with its own target flags (see dispatch/build.sh).
+template<size_t M> class FilterKernel{
+
+    public:
+
+        using State = std::array<std::array<float,4>,M>;
+
+        virtual ~FilterKernel(){};
+
+        virtual float* operator()(const float* first, const float* last, float* d_first) = 0;
+
+        virtual State state() = 0;
+
+        virtual void restore(const State& s) = 0;
+
+        virtual const char* isa() const = 0;
+};
+
+
+// one factory per instruction set, instantiated for the (M,N) pairs listed in dispatch/configs.h
+namespace dispatch{
+
+    template<size_t M,size_t N>
+    std::unique_ptr<FilterKernel<M>> make_sse(const float (&coefs)[M][5], const float (&inits)[M][4]);     // Vec4f
+
+    template<size_t M,size_t N>
+    std::unique_ptr<FilterKernel<M>> make_avx2(const float (&coefs)[M][5], const float (&inits)[M][4]);    // Vec8f
+
+    template<size_t M,size_t N>
+    std::unique_ptr<FilterKernel<M>> make_avx512(const float (&coefs)[M][5], const float (&inits)[M][4]);  // Vec16f
+}
+
+
+// Picks the widest Filter the CPU supports at construction, from VCL's instrset_detect:
+// >= 9 (AVX512F) Vec16f, >= 8 (AVX2) with FMA3 Vec8f, otherwise Vec4f.
+// N must be a multiple of 16 so that every variant can be built from the same configuration.
+template<size_t M,size_t N> class DispatchFilter{
+
+    static_assert(N % 16 == 0, "N must suit Vec4f, Vec8f and Vec16f");
+
+    private:
+
+        std::unique_ptr<FilterKernel<M>> _K;
+
+    public:
+
+        using State = typename FilterKernel<M>::State;
+
+        DispatchFilter(const float (&coefs)[M][5], const float (&inits)[M][4], const int instrset = instrset_detect()){
+
+            if (instrset >= 9) _K = dispatch::make_avx512<M,N>(coefs, inits);
+            else if (instrset >= 8 && hasFMA3()) _K = dispatch::make_avx2<M,N>(coefs, inits);
+            else _K = dispatch::make_sse<M,N>(coefs, inits);
+        };
+
+        inline float* operator()(const float* first, const float* last, float* d_first){ return (*_K)(first, last, d_first);};
+
+        inline void process(std::span<const float> chunk, std::span<float> out){ (*_K)(chunk.data(), chunk.data() + chunk.size(), out.data());};
+
+        inline void process(std::span<float> chunk){ (*_K)(chunk.data(), chunk.data() + chunk.size(), chunk.data());};
+
+        inline State state(){ return _K->state();};
+
+        inline void restore(const State& s){ _K->restore(s);};
+
+        // "sse", "avx2" or "avx512"
+        inline const char* isa() const { return _K->isa();};
+};
+
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef DYNAMIC_FILTER_H
+#define DYNAMIC_FILTER_H 1
+
+#include "iir_cores.h"
+#include "permute.h"
+#include <array>
+#include <vector>
+#include <span>
+#include <stdexcept>
+
+
+// Cascade of biquads whose number is only known at run time, e.g. designs loaded from a config.
+// Same paths as Filter, but the sections sit in one contiguous array and run in a plain loop
+// instead of the compile-time recursion of Series.
+template<typename V,size_t N,typename A = algo::CR> class DynamicFilter{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+
+    // cache-line aligned, so neighbouring sections never share a line
+    using Core = IirCoreOrderTwo<V,N,A>;
+
+    public:
+
+        // {xi1,xi2,yi1,yi2} per section, same layout as the constructor inits
+        using State = std::vector<std::array<T,4>>;
+
+    private:
+
+        std::vector<Core> _S;
+
+        template<typename U>
+        __attribute__((always_inline))
+        inline U _proc(U x){
+
+            for (auto& s : _S) x = s(x);
+            return x;
+        }
+
+        __attribute__((always_inline))
+        inline void _apply(std::array<V,N>& x){ for (auto& s : _S) s.apply(x);}
+
+        template<typename U>
+        inline void _sync(){ for (auto& s : _S) s.template sync<U>();}
+
+    public:
+
+        DynamicFilter(){};
+
+        // inits may be empty for a zero state, otherwise one row per section
+        DynamicFilter(std::span<const std::array<T,5>> coefs, std::span<const std::array<T,4>> inits = {}): _S(coefs.size()){
+
+            if (!inits.empty() && inits.size() != coefs.size())
+                throw std::invalid_argument("DynamicFilter: inits must be empty or have one row per section");
+
+            const T zero[4] = {0};
+
+            for (size_t m=0; m<coefs.size(); m++)
+                _S[m] = Core(coefs[m].data(), inits.empty() ? zero : inits[m].data());
+        };
+
+        inline size_t sections() const { return _S.size();};
+
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
+
+            std::array<V,N> x;
+
+            // multi-block: N vectors of L samples per step
+            while (last - first >= static_cast<std::ptrdiff_t>(N*L)){
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n].load(&*(first + n*L));
+
+                if constexpr (A::transposed){
+
+                    x = permuteV(x);
+                    _apply(x);
+                    x = depermuteV(x);
+                }
+                else _apply(x);
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n].store(&*(d_first + n*L));
+
+                first += N*L;
+                d_first += N*L;
+            }
+
+            _sync<std::array<V,N>>();
+
+            // remainder: single vectors of L samples
+            V xv;
+
+            while (last - first >= L){
+
+                xv.load(&*first);
+                _proc(xv).store(&*d_first);
+
+                first += L;
+                d_first += L;
+            }
+
+            _sync<V>();
+
+            // remainder: less than L samples
+            while (first != last){
+
+                *d_first = _proc(static_cast<T>(*first));
+
+                first += 1;
+                d_first += 1;
+            }
+
+            _sync<T>();
+
+            return d_first;
+        };
+
+        inline void process(std::span<const T> chunk, std::span<T> out){ (*this)(chunk.begin(), chunk.end(), out.begin());};
+
+        inline void process(std::span<T> chunk){ (*this)(chunk.begin(), chunk.end(), chunk.begin());};
+
+        inline State state(){
+
+            State s(_S.size());
+            for (size_t m=0; m<_S.size(); m++) s[m] = _S[m].template state<T>();
+            return s;
+        };
+
+        inline void restore(const State& s){ for (size_t m=0; m<_S.size(); m++) _S[m].reset(s[m]);};
+
+};
+
+
+#endif
@@ -3,93 +3,303 @@
 
 #include "series.h"
 #include "permute.h"
+#include "lanes.h"
+#include "prefetch.h"
+#include <span>
+#include <algorithm>
+#include <cstdint>
 
 
 
-template<typename V,size_t M,size_t N> class Filter{
+// A selects the multi-block algorithm of every section, see algo:: in iir_cores.h. With Odd the last of the
+// M sections is first order (IirCoreOrderOne), so an order 2M-1 design does not pay for a zeroed biquad.
+template<typename V,size_t M,size_t N,typename A = algo::CR,bool Odd = false> class Filter{
 
     using T = decltype(std::declval<V>().extract(0));
     constexpr static int L = V::size(); 
 
+    public:
+
+        // {xi1,xi2,yi1,yi2} per section, same layout as the constructor inits, {xi1,0,yi1,0} for a first-order one
+        using State = std::array<std::array<T,4>,M>;
+
     private:
 
-        using Series_t = decltype(series_from_coeffs<T,V,N>(std::declval<const T (&)[M][5]>(), std::declval<const T (&)[M][4]>())); 
+        using Series_t = decltype(series_from_coeffs<T,V,N,A,Odd>(std::declval<const T (&)[M][5]>(), std::declval<const T (&)[M][4]>())); 
         Series_t _S;
 
+        // software prefetch distance in samples, 0 leaves it to the hardware prefetcher
+        size_t _pf = 0;
+
+        // the input lines of the block starting at p, _pf samples ahead but not past last
+        template<typename It>
+        __attribute__((always_inline))
+        inline void _prefetch(It p, It last){ 
+            if (_pf) prefetch_lines(&*p + std::min<size_t>(_pf, last - p), N*L*sizeof(T));
+        };
+
+        // into and out of the block layout the cores of A work on
+        __attribute__((always_inline))
+        inline static std::array<V,N> _in(const std::array<V,N>& x){ 
+            if constexpr (A::transposed) return permuteV(x); else return x;
+        };
+
+        __attribute__((always_inline))
+        inline static std::array<V,N> _out(const std::array<V,N>& y_T){ 
+            if constexpr (A::transposed) return depermuteV(y_T); else return y_T;
+        };
+
+        // load_a/store_a when the caller guarantees sizeof(V) alignment
+        template<bool aligned, typename It>
+        __attribute__((always_inline))
+        inline static void _load(V& v, It p){ 
+            if constexpr (aligned) v.load_a(&*p); else v.load(&*p);
+        };
+
+        // nt: non-temporal store_nt past the caches, the output must be sizeof(V) aligned
+        template<bool aligned, bool nt, typename It>
+        __attribute__((always_inline))
+        inline static void _store(const V& v, It p){ 
+            if constexpr (nt) v.store_nt(&*p); else if constexpr (aligned) v.store_a(&*p); else v.store(&*p);
+        };
+
+        template<bool aligned, bool nt = false, typename InputIt, typename OutputIt>
+        __attribute__((always_inline))
+        inline OutputIt _run(InputIt first, InputIt last, OutputIt d_first) {
+            
+            std::array<V,N> x;
+
+            // multi-block: N vectors of L samples per step, filtered in place
+            while (last - first >= static_cast<std::ptrdiff_t>(N*L)){
+
+                _prefetch(first, last);
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) _load<aligned>(x[n], first + n*L);  
+
+                x = _in(x);
+                _S.apply(x);
+                x = _out(x);
+               
+                #pragma unroll
+                for (size_t n=0; n<N; n++) _store<aligned,nt>(x[n], d_first + n*L);
+
+                first += N*L;
+                d_first += N*L;
+
+            }
+
+            _S.template sync<std::array<V,N>>();
+
+            // remainder: single vectors of L samples
+            V xv, yv;
+
+            while (last - first >= L){
+
+                _load<aligned>(xv, first);  
+                yv = _S(xv);
+                _store<aligned,nt>(yv, d_first);
+
+                first += L;
+                d_first += L;
+            }
+
+            _S.template sync<V>();
+
+            // non-temporal stores are weakly ordered, make them visible before the scalar tail and the caller
+            if constexpr (nt) _mm_sfence();
+
+            // remainder: less than L samples
+            while (first != last){
+
+                *d_first = _S(static_cast<T>(*first));
+
+                first += 1;
+                d_first += 1;
+            }
+
+            _S.template sync<T>();
+
+            return d_first;
+        };
+
     public:
 
         Filter(){};
         
         __attribute__((always_inline))
-        Filter(const T (&coefs)[M][5], const T (&inits)[M][4]): _S(series_from_coeffs<T,V,N>(coefs, inits)){}; 
+        Filter(const T (&coefs)[M][5], const T (&inits)[M][4]): _S(series_from_coeffs<T,V,N,A,Odd>(coefs, inits)){}; 
 
         
 
-        // template<typename InputIt, typename OutputIt>
-        // __attribute__((always_inline))
-        // inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
-            
-        //     std::array<V,N> x, y, x_T, y_T;
+        template<typename InputIt, typename OutputIt>
+        __attribute__((always_inline))
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) { return _run<false>(first, last, d_first);};
 
-        //     while (first <= last - N*L){
+        // software-pipelined: section k works on block b while section k+1 works on block b-1
+        template<typename InputIt, typename OutputIt>
+        __attribute__((always_inline))
+        inline OutputIt pipelined(InputIt first, InputIt last, OutputIt d_first) {
 
-        //         #pragma unroll
-        //         for (auto n=0; n<N; n++) x[n].load(&*(first + n*L));  
+            const size_t nb = (last - first)/(N*L);
 
-        //         x_T = permuteV(x);
-        //         y_T = _S(x_T);
-        //         y = depermuteV(y_T);
-               
-        //         #pragma unroll
-        //         for (auto n=0; n<N; n++) y[n].store(&*(d_first + n*L));
+            std::array<std::array<V,N>,M> w;
+            std::array<V,N> x, y;
 
-        //         first += N*L;
-        //         d_first += N*L;
+            auto load = [&](const size_t b){
 
-        //     }
+                _prefetch(first + b*N*L, last);
 
-        //     return d_first;
-        // };
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n].load(&*(first + (b*N + n)*L));  
 
+                w[b % M] = _in(x);
+            };
 
-        // template<typename InputIt, typename OutputIt> 
-        // __attribute__((always_inline))
-        // inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
-            
-        //     V x, y;
+            auto store = [&](const size_t b){
 
-        //     while (first <= last - L) {
+                y = _out(w[b % M]);
 
-        //         x.load(&*first);  
-            
-        //         y = _S(x);
+                #pragma unroll
+                for (size_t n=0; n<N; n++) y[n].store(&*(d_first + (b*N + n)*L));
+            };
 
-        //         y.store(&*d_first);
+            size_t s = 0;
 
-        //         first += L;
-        //         d_first += L;
-        //     }
+            // fill
+            for (; s < std::min(nb, M-1); s++){
 
-        //     return d_first;
-        // };
+                load(s);
+                _S.wavefront(w, s, nb);
+            }
+
+            // steady state, every section is busy
+            for (; s < nb; s++){
+
+                load(s);
+                _S.wavefront(w, s);
+                store(s + 1 - M);
+            }
 
+            // drain
+            for (; s < nb + M - 1; s++){
 
-        template<typename InputIt, typename OutputIt> 
+                _S.wavefront(w, s, nb);
+                if (s + 1 >= M) store(s + 1 - M);
+            }
+
+            // the tail, this also syncs the granularities
+            return (*this)(first + nb*N*L, last, d_first + nb*N*L);
+        };
+
+        // backwards in time, y[n] = x[n] + b1*x[n+1] + b2*x[n+2] + a1*y[n+1] + a2*y[n+2] per section, with the state
+        // holding the samples that follow the range. [first, last) is consumed from its end: a block is loaded
+        // vector N-1 first with its lanes reversed, so the forward cores see it in reversed time and no copy of
+        // the range is ever reversed. Writes [d_last - (last - first), d_last) and returns its begin, may be in place.
+        template<typename InputIt, typename OutputIt>
         __attribute__((always_inline))
-        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
-    
-            while (first <= last - 1){
-               
-                *d_first = _S(*first);
+        inline OutputIt reversed(InputIt first, InputIt last, OutputIt d_last) {
 
-                first += 1;
-                d_first += 1;
+            std::array<V,N> x;
+
+            while (last - first >= static_cast<std::ptrdiff_t>(N*L)){
+
+                last -= N*L;
+                d_last -= N*L;
+
+                if (_pf) prefetch_lines(&*last - std::min<size_t>(_pf, last - first), N*L*sizeof(T));
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++){ 
+                    x[n].load(&*(last + (N-1-n)*L));  
+                    x[n] = permute_lanes<lane_reverse>(x[n]);
+                }
+
+                x = _in(x);
+                _S.apply(x);
+                x = _out(x);
 
+                #pragma unroll
+                for (size_t n=0; n<N; n++) permute_lanes<lane_reverse>(x[n]).store(&*(d_last + (N-1-n)*L));
             }
 
-            return d_first;
+            _S.template sync<std::array<V,N>>();
+
+            // remainder at the front: single vectors of L samples
+            V xv;
+
+            while (last - first >= L){
+
+                last -= L;
+                d_last -= L;
+
+                xv.load(&*last);
+                permute_lanes<lane_reverse>(_S(permute_lanes<lane_reverse>(xv))).store(&*d_last);
+            }
+
+            _S.template sync<V>();
+
+            // remainder: less than L samples
+            while (first != last){
+
+                last -= 1;
+                d_last -= 1;
+
+                *d_last = _S(static_cast<T>(*last));
+            }
+
+            _S.template sync<T>();
+
+            return d_last;
         };
 
+        // prefetch distance of the block loops in samples, e.g. from the autotuner; 0 disables it
+        inline void prefetch(const size_t distance){ _pf = distance;};
+
+        inline size_t prefetch() const { return _pf;};
+
+        // streaming: chunks may have any length, the recursion carries over between calls
+        inline void process(std::span<const T> chunk, std::span<T> out){ (*this)(chunk.begin(), chunk.end(), out.begin());};
+
+        inline void process(std::span<T> chunk){ (*this)(chunk.begin(), chunk.end(), chunk.begin());};
+
+        // in place: a head of less than L samples runs scalar until the buffer is sizeof(V) aligned, the rest
+        // uses aligned loads and stores, so no vector straddles a cache line
+        inline void filter_inplace(std::span<T> x){ 
+
+            const size_t mis = reinterpret_cast<std::uintptr_t>(x.data()) % sizeof(V);
+            const size_t head = std::min(x.size(), mis ? (sizeof(V) - mis)/sizeof(T) : 0);
+
+            (*this)(x.data(), x.data() + head, x.data());
+            _run<true>(x.data() + head, x.data() + x.size(), x.data() + head);
+        };
+
+        // for outputs far larger than the LLC: the vector paths write with store_nt, so y does not evict
+        // data that is still needed. A head of less than L samples runs scalar until d_first is aligned.
+        inline T* streamed(const T* first, const T* last, T* d_first){ 
+
+            const size_t mis = reinterpret_cast<std::uintptr_t>(d_first) % sizeof(V);
+            const size_t head = std::min<size_t>(last - first, mis ? (sizeof(V) - mis)/sizeof(T) : 0);
+
+            d_first = (*this)(first, first + head, d_first);
+            first += head;
+
+            if (reinterpret_cast<std::uintptr_t>(first) % sizeof(V) == 0) return _run<true,true>(first, last, d_first);
+            else return _run<false,true>(first, last, d_first);
+        };
+
+        // vectors are aligned by construction, x holds x.size()*L consecutive samples
+        inline void filter_inplace(std::span<V> x){ 
+
+            T* p = reinterpret_cast<T*>(x.data());
+            _run<true>(p, p + x.size()*L, p);
+        };
+
+        // checkpoint of the stream, e.g. to migrate it to another worker
+        inline State state(){ State s; _S.template state<T>(s); return s;};
+
+        inline void restore(const State& s){ _S.reset(s);};
+
 };
 
 
@@ -0,0 +1,105 @@
+#ifndef FILTFILT_H
+#define FILTFILT_H 1
+
+#include "filter.h"
+#include <array>
+#include <algorithm>
+
+
+// Zero-phase filtering of a whole signal, as scipy.signal.sosfiltfilt: the cascade runs forward, then backward
+// over its own output, which squares the magnitude response and cancels the phase. The signal is extended by
+// odd reflection about its end points, P samples on each side, and each pass starts from the steady state of
+// its first sample (the lfilter_zi equivalent), so the edges carry no start-up transient.
+// The extensions live in two buffers of P samples and the backward pass runs Filter::reversed on the output,
+// so x is never copied or reversed and the cost stays close to two forward passes.
+// Odd as in Filter, the last section is first order.
+template<typename V,size_t M,size_t N,typename A = algo::CR,bool Odd = false> class FiltFilt{
+
+    using T = decltype(std::declval<V>().extract(0));
+    using State = typename Filter<V,M,N,A,Odd>::State;
+
+    public:
+
+        // extension on each side, scipy's default padlen: three times the number of taps
+        constexpr static size_t P = 3*(2*M + 1 - Odd);
+
+    private:
+
+        constexpr static T _zero[M][4] = {};
+
+        Filter<V,M,N,A,Odd> _F;
+
+        // {xi1,xi2,yi1,yi2} of every section for a constant input of 1
+        State _zi;
+
+        inline void _start(const T x0){
+
+            State s;
+            for (size_t m=0; m<M; m++) for (size_t i=0; i<4; i++) s[m][i] = _zi[m][i]*x0;
+            _F.restore(s);
+        };
+
+    public:
+
+        FiltFilt(){};
+
+        // the initial states of coefs are ignored, both passes start from the steady state. Sections need a finite
+        // DC gain, 1 - a1 - a2 != 0.
+        FiltFilt(const T (&coefs)[M][5]): _F(coefs, _zero){
+
+            T u = 1;
+
+            for (size_t m=0; m<M; m++){
+
+                const bool o = Odd && m == M-1;
+                const T g = (1 + coefs[m][1] + (o ? 0 : coefs[m][2]))/(1 - coefs[m][3] - (o ? 0 : coefs[m][4]));
+
+                _zi[m] = {u, u, g*u, g*u};
+                u *= g;
+            }
+        };
+
+        // inputs of P samples or less are extended by last - first - 1 samples instead, like a shorter padlen
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
+
+            const size_t n = last - first;
+            if (n == 0) return d_first;
+
+            const size_t p = std::min(P, n - 1);
+            const T x0 = first[0], xn = first[n-1];
+
+            // odd extensions, taken before an in-place forward pass overwrites x
+            std::array<T,P> l, r;
+
+            for (size_t k=0; k<p; k++){
+
+                l[k] = 2*x0 - static_cast<T>(first[p-k]);
+                r[k] = 2*xn - static_cast<T>(first[n-2-k]);
+            }
+
+            // forward over left extension, x and right extension
+            _start(p ? l[0] : x0);
+            _F(l.data(), l.data() + p, l.data());
+            _F(first, last, d_first);
+            _F(r.data(), r.data() + p, r.data());
+
+            // backward from the end of the right extension, the left one only fed the forward pass
+            _start(p ? r[p-1] : static_cast<T>(d_first[n-1]));
+            _F.reversed(r.data(), r.data() + p, r.data() + p);
+            _F.reversed(d_first, d_first + n, d_first + n);
+
+            return d_first + n;
+        };
+
+        inline void filter_inplace(std::span<T> x){ (*this)(x.data(), x.data() + x.size(), x.data());};
+
+        // prefetch distance of both passes in samples, 0 disables it
+        inline void prefetch(const size_t distance){ _F.prefetch(distance);};
+
+        inline size_t prefetch() const { return _F.prefetch();};
+
+};
+
+
+#endif // header guard
@@ -4,6 +4,7 @@
 
 #include "../src/vcl/vectorclass.h"
 #include "shift_reg.h"
+#include "lanes.h"
 #include <array>
 
 
@@ -36,55 +37,154 @@ template<typename V,size_t N> class FirCoreOrderTwo{
         };
 
 
+        // in place, from the last block down so that x[n-1], x[n-2] are still the input when x[n] is written
         __attribute__((always_inline))
-        inline std::array<V,N> operator()(const std::array<V,N>& x){
+        inline void apply(std::array<V,N>& x){
 
-            V xvi2, xvi1;
+            V xvi2 = blend_lanes<shift_in>(x[N-2], _S[-2]);
+            V xvi1 = blend_lanes<shift_in>(x[N-1], _S[-1]);
 
-            // SSE
-            if constexpr (L == 4){
+            _S.shift(x[N-2][L-1]); // xi2, xi1 lies the last two (different) blocks.
+            _S.shift(x[N-1][L-1]);
 
-                xvi2 = blend4<4,0,1,2>(x[N-2], _S[-2]);
-                xvi1 = blend4<4,0,1,2>(x[N-1], _S[-1]);
-            }
+            #pragma unroll  
+            for (auto n=N-1; n>=2; n--){
 
-            // AVX2
-            if constexpr (L == 8){
-                
-                xvi2 = blend8<8,0,1,2,3,4,5,6>(x[N-2], _S[-2]);
-                xvi1 = blend8<8,0,1,2,3,4,5,6>(x[N-1], _S[-1]);
+                x[n] = mul_add(x[n-2], _b2, x[n]);
+                x[n] = mul_add(x[n-1], _b1, x[n]);
             }
 
-            // AVX512
-            if constexpr (L == 16){
+            V x0 = x[0];
 
-                xvi2 = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(x[N-2], _S[-2]);
-                xvi1 = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(x[N-1], _S[-1]);
-            }
+            x[0] = mul_add(xvi2, _b2, x0); // interleave FMA of x[0] and x[1]
+            x[1] = mul_add(xvi1, _b2, x[1]);
+            x[0] = mul_add(xvi1, _b1, x[0]);
+            x[1] = mul_add(x0, _b1, x[1]);
+        }
+
+        __attribute__((always_inline))
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
+
+            std::array<V,N> v = x;
+            apply(v);
+
+            return v;
+        }
+
+        inline void reset(){ _S.reset();};
+
+        template<typename U> inline void reset(const U x){ _S.shift(x);};
+
+        inline void reset(const T xi1,const T xi2){ _S.shift(xi2); _S.shift(xi1);};
+
+        inline std::array<T,2> state(){ return {_S[-1],_S[-2]};};
+
+};
+
+// order one, x[n] + b1*x[n-1]: one FMA per vector
+template<typename V,size_t N> class FirCoreOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
 
-            std::array<V,N> v;
+    constexpr static int L = V::size(); 
 
-            v[0] = mul_add(xvi2, _b2, x[0]); // interleave FMA of v[0] and v[1]
-            v[1] = mul_add(xvi1, _b2, x[1]);
-            v[0] = mul_add(xvi1, _b1, v[0]);
-            v[1] = mul_add(x[0], _b1, v[1]);
+    private:
+
+        Shift<V> _S;
+
+        T _b1;
+
+    public:
+
+        FirCoreOrderOne(){};
+
+        FirCoreOrderOne(const T b1,const T xi1=0): _b1(b1){ _S.shift(xi1);};
+
+        // in place, from the last block down
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+
+            V xvi1 = blend_lanes<shift_in>(x[N-1], _S[-1]);
+
+            _S.shift(x[N-1][L-1]);
 
             #pragma unroll  
-            for (auto n=2; n<N; n++){
+            for (auto n=N-1; n>=1; n--) x[n] = mul_add(x[n-1], _b1, x[n]);
 
-                v[n] = mul_add(x[n-2], _b2, x[n]);
-                v[n] = mul_add(x[n-1], _b1, v[n]);
+            x[0] = mul_add(xvi1, _b1, x[0]);
+        }
+
+        __attribute__((always_inline))
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
+
+            std::array<V,N> v = x;
+            apply(v);
+
+            return v;
+        }
+
+        inline void reset(const T xi1){ _S.shift(xi1);};
+
+        inline T state(){ return _S[-1];};
+
+};
+
+
+// order K, x[n] + b1*x[n-1] + ... + bK*x[n-K]: K FMAs per vector, N >= K
+template<typename V,size_t N,size_t K> class FirCoreOrderK{
+
+    static_assert(N >= K, "the previous lane's tail must fit in one block");
+
+    using T = decltype(std::declval<V>().extract(0));
+
+    constexpr static int L = V::size(); 
+
+    private:
+
+        T _b[K];
+
+        // x[-1], ..., x[-K]
+        std::array<T,K> _xi;
+
+    public:
+
+        FirCoreOrderK(){};
+
+        FirCoreOrderK(const T (&b)[K],const std::array<T,K>& xi = {}): _xi(xi){ 
+            for (size_t k=0; k<K; k++) _b[k] = b[k];
+        };
+
+        // in place, from the last block down; x[n-k] of the first blocks comes from the previous lane
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+
+            std::array<V,K> xvi;
+
+            #pragma unroll
+            for (size_t m=0; m<K; m++){
+
+                xvi[m] = blend_lanes<shift_in>(x[N-1-m], _xi[m]);
+                _xi[m] = x[N-1-m][L-1];
             }
 
-            _S.shift(x[N-2][L-1]); // xi2, xi1 lies the last two (different) blocks.
-            _S.shift(x[N-1][L-1]);
+            #pragma unroll  
+            for (size_t n=N; n-- > 0; )
+                #pragma unroll  
+                for (size_t k=1; k<=K; k++) x[n] = mul_add(n >= k ? x[n-k] : xvi[k-n-1], _b[k-1], x[n]);
+        }
+
+        __attribute__((always_inline))
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
+
+            std::array<V,N> v = x;
+            apply(v);
 
             return v;
         }
 
-        inline void reset(){ _S.reset();};
+        inline void reset(const std::array<T,K>& xi){ _xi = xi;};
 
-        template<typename U> inline void reset(const U x){ _S.shift(x);};
+        inline std::array<T,K> state(){ return _xi;};
 
 };
 
@@ -92,6 +192,7 @@ template<typename V,size_t N> class FirCoreOrderTwo{
 
 
 
+
 #endif
 
 
@@ -0,0 +1,470 @@
+#ifndef FIXED_CORES_H
+#define FIXED_CORES_H 1
+
+#include "../src/vcl/vectorclass.h"
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <span>
+#include <type_traits>
+#include <cstdint>
+#include "shift_reg.h"
+#include "lanes.h"
+#include "permute.h"
+
+
+// Fixed point: Q15 samples in int16 lanes (Vec16s, Vec32s), Q31 samples in int32 lanes (Vec8i, Vec16i). Each vector
+// is widened to two vectors of the double lane width (Vec8i, Vec16i, Vec4q, Vec8q) for the products, so a Q15 block
+// keeps 16 samples per AVX2 register in memory and in the loads and stores.
+// Coefficients have F fraction bits in the wide lanes. Sums of products are taken modulo the wide width: the VCL
+// lanes wrap, the scalar paths add in the unsigned type, so only the result has to fit, and the unsaturated output
+// must stay below 2^(2D+1-F) in LSB of the D-bit samples, 4x full scale for the default F = D-1.
+// Results are rounded once per output and saturated.
+// Q31 products are 64 bits wide. AVX2 has no 64-bit lane multiply, VCL emulates it in three 32-bit multiplies, and
+// AVX-512DQ's vpmullq is no cheaper. Products of a sample with coefficients that fit in int32 use one vpmuldq
+// instead (_mm256_mul_epi32 on AVX2, _mm512_mul_epi32 on AVX-512F); sections with larger coefficients, e.g.
+// b1 = 2 at the default F = 30, and the products with the unsaturated outputs keep the 64-bit multiply.
+namespace fixed{
+
+    enum class Round { truncate, nearest };
+
+    template<typename V> using Wide = decltype(extend_low(std::declval<V>()));
+
+    // fraction bits of the samples, 15 or 31
+    template<typename V> constexpr int frac_bits = 8*sizeof(decltype(std::declval<V>().extract(0))) - 1;
+
+    template<typename V,int F>
+    inline auto quantize(const double c){
+        using E = decltype(std::declval<Wide<V>>().extract(0));
+        return static_cast<E>(std::llround(std::ldexp(c, F)));
+    };
+
+    // acc + c*x and x*2^F modulo 2^bits, as the vector lanes; signed overflow would be undefined
+    template<typename E>
+    inline E mul_add(const E x, const E c, const E acc){
+        using U = std::make_unsigned_t<E>;
+        return static_cast<E>(U(acc) + U(c)*U(x));
+    };
+
+    template<int F,typename E>
+    inline E shift_left(const E x){
+        using U = std::make_unsigned_t<E>;
+        return static_cast<E>(U(x) << F);
+    };
+
+    // accumulator with F fraction bits to integer, floor or round half up; vectors and scalars alike
+    template<int F,Round R,typename W>
+    __attribute__((always_inline))
+    inline W round_shift(const W acc){
+
+        if constexpr (R == Round::truncate) return acc >> F;
+        else if constexpr (std::is_integral_v<W>) return mul_add(W(1), W(1) << (F-1), acc) >> F;
+        else return (acc + (W(1) << (F-1))) >> F;
+    };
+
+    template<typename V>
+    __attribute__((always_inline))
+    inline std::array<Wide<V>,2> widen(const V x){ return {extend_low(x), extend_high(x)};};
+
+    template<typename V>
+    __attribute__((always_inline))
+    inline V narrow(const std::array<Wide<V>,2>& w){ return compress_saturated(w[0], w[1]);};
+
+    // the coefficient is within the low 32 bits vpmuldq reads, always true for Q15
+    template<typename E>
+    inline bool narrow_range(const E c){
+        return c >= std::numeric_limits<int32_t>::min() && c <= std::numeric_limits<int32_t>::max();
+    };
+
+    // w*c where the lanes of both hold values within int32, a sample and a coefficient within narrow_range; the
+    // 32-bit lanes of Q15 multiply natively
+    template<typename W>
+    __attribute__((always_inline))
+    inline W mul_narrow(const W w, const W c){
+#if INSTRSET >= 9
+        if constexpr (std::is_same_v<W,Vec8q>) return _mm512_mul_epi32(w, c);
+#endif
+#if INSTRSET >= 8
+        if constexpr (std::is_same_v<W,Vec4q>) return _mm256_mul_epi32(w, c);
+#endif
+        return w*c;
+    };
+
+    template<typename T,typename E>
+    inline T saturate(const E y){
+        return static_cast<T>(std::clamp<E>(y, std::numeric_limits<T>::min(), std::numeric_limits<T>::max()));
+    };
+}
+
+
+// FirCoreOrderTwo in fixed point, x[n] + b1*x[n-1] + b2*x[n-2]. apply() takes blocks of N vectors in the permuteV
+// layout as FirCoreOrderTwo, the vector and scalar paths take samples in order. Outputs saturate.
+template<typename V,size_t N,int F = fixed::frac_bits<V>-1,fixed::Round R = fixed::Round::nearest> class FixedFirCoreOrderTwo{
+
+    using T = decltype(std::declval<V>().extract(0));
+    using W = fixed::Wide<V>;
+    using E = decltype(std::declval<W>().extract(0));
+
+    constexpr static int L = V::size();
+
+    static_assert(N >= 2);
+
+    private:
+
+        Shift<V> _S;
+
+        E _b1, _b2;
+
+        // both taps within int32, see fixed::mul_narrow
+        bool _narrow = true;
+
+        __attribute__((always_inline))
+        inline V _fir(const V x, const V x1, const V x2){
+
+            auto w = fixed::widen(x), w1 = fixed::widen(x1), w2 = fixed::widen(x2);
+
+            if (_narrow){
+
+                #pragma unroll
+                for (size_t h=0; h<2; h++) 
+                    w[h] = fixed::round_shift<F,R>((w[h] << F) + fixed::mul_narrow(w1[h], W(_b1)) + fixed::mul_narrow(w2[h], W(_b2)));
+            }
+            else{
+
+                #pragma unroll
+                for (size_t h=0; h<2; h++) w[h] = fixed::round_shift<F,R>((w[h] << F) + w1[h]*_b1 + w2[h]*_b2);
+            }
+
+            return fixed::narrow<V>(w);
+        };
+
+    public:
+
+        FixedFirCoreOrderTwo(){};
+
+        FixedFirCoreOrderTwo(const double b1,const double b2,const T xi1=0,const T xi2=0):
+            _b1(fixed::quantize<V,F>(b1)), _b2(fixed::quantize<V,F>(b2)),
+            _narrow(fixed::narrow_range(_b1) && fixed::narrow_range(_b2)){
+
+            _S.shift(xi2);
+            _S.shift(xi1);
+        };
+
+        __attribute__((always_inline))
+        inline T operator()(const T x){
+
+            E acc = fixed::shift_left<F>(E(x));
+            acc = fixed::mul_add(E(_S[-1]), _b1, acc);
+            acc = fixed::mul_add(E(_S[-2]), _b2, acc);
+
+            _S.shift(x);
+
+            return fixed::saturate<T>(fixed::round_shift<F,R>(acc));
+        }
+
+        // L consecutive samples
+        __attribute__((always_inline))
+        inline V operator()(const V x){
+
+            V x1 = blend_lanes<shift_in>(x, _S[-1]);
+            V x2 = blend_lanes<shift_in>(x1, _S[-2]);
+
+            _S.shift(x);
+
+            return _fir(x, x1, x2);
+        }
+
+        // in place on a transposed block, from the last block down as FirCoreOrderTwo
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+
+            V xvi2 = blend_lanes<shift_in>(x[N-2], _S[-2]);
+            V xvi1 = blend_lanes<shift_in>(x[N-1], _S[-1]);
+
+            _S.shift(x[N-2][L-1]);
+            _S.shift(x[N-1][L-1]);
+
+            #pragma unroll
+            for (auto n=N-1; n>=2; n--) x[n] = _fir(x[n], x[n-1], x[n-2]);
+
+            x[1] = _fir(x[1], x[0], xvi1);
+            x[0] = _fir(x[0], xvi1, xvi2);
+        }
+
+        __attribute__((always_inline))
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
+
+            std::array<V,N> v = x;
+            apply(v);
+
+            return v;
+        }
+
+        inline void reset(){ _S.reset();};
+
+        inline void reset(const T xi1,const T xi2){ _S.shift(xi2); _S.shift(xi1);};
+
+        inline std::array<T,2> state(){ return {_S[-1],_S[-2]};};
+
+};
+
+
+// BlockFiltering in fixed point: one vector of L samples as the L x L impulse response matrix plus the responses to
+// the initial values, all summed exactly in the wide lanes and rounded once. The matrix is the closed form of what
+// recursive doubling computes across the lanes; doubling in fixed point would round at every step and needs the
+// powers of the companion matrix, which outgrow the coefficient range of resonant sections.
+// Only the stored outputs saturate. The recursion runs on the outputs before saturation: within a vector exactly,
+// between vectors and in the scalar path on the rounded values, carried in the wide type. Clipping therefore doesn't
+// feed back, and outputs of different chunkings differ by rounding only, a few LSB, also where they clip.
+template<typename V,int F = fixed::frac_bits<V>-1,fixed::Round R = fixed::Round::nearest> class FixedBlockFiltering{
+
+    using T = decltype(std::declval<V>().extract(0));
+    using W = fixed::Wide<V>;
+    using E = decltype(std::declval<W>().extract(0));
+
+    constexpr static int L = V::size();
+    constexpr static int Lw = W::size();
+
+    private:
+
+        E _b1, _b2, _a1, _a2;
+
+        // response of the output lanes to x[l], per half
+        std::array<std::array<W,2>,L> _H;
+
+        std::array<W,2> _p2, _p1, _h2, _h1;
+
+        Shift<V> _PS;
+
+        // y[-1], y[-2] before saturation
+        E _yi1 = 0, _yi2 = 0;
+
+        // _H, _p2 and _p1 within int32, their products with the samples use fixed::mul_narrow
+        bool _narrow = true;
+
+        inline static std::array<W,2> _load(const double* c){
+
+            E q[L];
+            for (int l=0; l<L; l++) q[l] = fixed::quantize<V,F>(c[l]);
+
+            std::array<W,2> w;
+            w[0].load(&q[0]);
+            w[1].load(&q[Lw]);
+
+            return w;
+        };
+
+        template<bool narrow>
+        __attribute__((always_inline))
+        inline V _block(const V x){
+
+            auto mul = [](const W c, const E v){ if constexpr (narrow) return fixed::mul_narrow(c, W(v)); else return c*v;};
+
+            const E xi2 = _PS[-2], xi1 = _PS[-1];
+
+            std::array<W,2> acc;
+
+            // the outputs before saturation may exceed int32, their products stay 64-bit
+            #pragma unroll
+            for (size_t h=0; h<2; h++) acc[h] = mul(_p2[h], xi2) + mul(_p1[h], xi1) + _h2[h]*_yi2 + _h1[h]*_yi1;
+
+            // the lower half doesn't depend on the upper half of x
+            #pragma unroll
+            for (auto l=0; l<Lw; l++) acc[0] += mul(_H[l][0], E(x[l]));
+
+            #pragma unroll
+            for (auto l=0; l<L; l++) acc[1] += mul(_H[l][1], E(x[l]));
+
+            #pragma unroll
+            for (size_t h=0; h<2; h++) acc[h] = fixed::round_shift<F,R>(acc[h]);
+
+            _PS.shift(x);
+            _yi1 = acc[1][Lw-1];
+            _yi2 = acc[1][Lw-2];
+
+            return fixed::narrow<V>(acc);
+        };
+
+    public:
+
+        FixedBlockFiltering(){};
+
+        // the responses are taken in double from the unquantized coefficients, then quantized
+        FixedBlockFiltering(const double b1,const double b2,const double a1,const double a2,const T xi1=0,const T xi2=0,const E yi1=0,const E yi2=0):
+            _b1(fixed::quantize<V,F>(b1)), _b2(fixed::quantize<V,F>(b2)), _a1(fixed::quantize<V,F>(a1)), _a2(fixed::quantize<V,F>(a2)),
+            _yi1(yi1), _yi2(yi2){
+
+            double p2[L+1]={0}, p1[L+1]={0}, h0[L+1]={0}, h2[L]={0}, g[2*L]={0};
+
+            p2[0] = b2;
+            p2[1] = a1*b2;
+            p1[0] = b1;
+            p1[1] = a1*b1 + b2;
+            h0[0] = 1;
+            h0[1] = a1;
+
+            for (auto l=2; l<L+1; l++){
+
+                p2[l] = a1*p2[l-1] + a2*p2[l-2];
+                p1[l] = a1*p1[l-1] + a2*p1[l-2];
+                h0[l] = a1*h0[l-1] + a2*h0[l-2];
+            }
+
+            for (auto l=0; l<L; l++) h2[l] = a2*h0[l];
+
+            _p2 = _load(&p2[0]);
+            _p1 = _load(&p1[0]);
+            _h1 = _load(&h0[1]);
+            _h2 = _load(&h2[0]);
+
+            // impulse response g, zero before lag 0: lane j of _H[l] is g[j-l]
+            g[L] = 1;
+            for (auto m=1; m<L; m++) g[L+m] = h0[m] + p1[m-1];
+
+            for (auto l=0; l<L; l++) _H[l] = _load(&g[L-l]);
+
+            for (auto l=0; l<L; l++) 
+                _narrow = _narrow && fixed::narrow_range(fixed::quantize<V,F>(g[L+l])) && 
+                          fixed::narrow_range(fixed::quantize<V,F>(p2[l])) && fixed::narrow_range(fixed::quantize<V,F>(p1[l]));
+
+            _PS.shift(xi2);
+            _PS.shift(xi1);
+        };
+
+        inline V operator()(const V x){ return _narrow ? _block<true>(x) : _block<false>(x);};
+
+        // one sample, direct form I with the quantized coefficients
+        inline T operator()(const T x){
+
+            E acc = fixed::shift_left<F>(E(x));
+            acc = fixed::mul_add(E(_PS[-1]), _b1, acc);
+            acc = fixed::mul_add(E(_PS[-2]), _b2, acc);
+            acc = fixed::mul_add(_yi1, _a1, acc);
+            acc = fixed::mul_add(_yi2, _a2, acc);
+
+            _PS.shift(x);
+            _yi2 = _yi1;
+            _yi1 = fixed::round_shift<F,R>(acc);
+
+            return fixed::saturate<T>(_yi1);
+        };
+
+        // streaming over int16_t/int32_t samples: chunks may have any length, the recursion carries over
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
+
+            V xv;
+
+            while (last - first >= L){
+
+                xv.load(&*first);
+                (*this)(xv).store(&*d_first);
+
+                first += L;
+                d_first += L;
+            }
+
+            while (first != last){
+
+                *d_first = (*this)(static_cast<T>(*first));
+
+                first += 1;
+                d_first += 1;
+            }
+
+            return d_first;
+        };
+
+        inline void reset(const T xi1,const T xi2,const E yi1,const E yi2){
+
+            _PS.shift(xi2);
+            _PS.shift(xi1);
+            _yi1 = yi1;
+            _yi2 = yi2;
+        };
+
+        // {xi1, xi2, yi1, yi2}, the outputs before saturation
+        inline std::array<E,4> state(){ return {_PS[-1],_PS[-2],_yi1,_yi2};};
+
+};
+
+
+// Second-order section from int samples to int samples: the FIR part over blocks of N vectors in the permuteV
+// layout, then the recursion of FixedBlockFiltering vector by vector in sample order. The FIR output saturates
+// before the recursion, so the numerator must not amplify beyond full scale; scale b0..b2 down and move the gain
+// elsewhere if it would. permuteV covers up to 16 lanes: Vec16s, Vec8i, Vec16i.
+template<typename V,size_t N,int F = fixed::frac_bits<V>-1,fixed::Round R = fixed::Round::nearest> class FixedSectionOrderTwo{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+
+    static_assert(L <= 16, "no permuteV beyond 16 lanes");
+
+    private:
+
+        FixedFirCoreOrderTwo<V,N,F,R> _F;
+        FixedBlockFiltering<V,F,R> _R;
+
+    public:
+
+        FixedSectionOrderTwo(){};
+
+        FixedSectionOrderTwo(const double b1,const double b2,const double a1,const double a2): _F(b1, b2), _R(0, 0, a1, a2){};
+
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
+
+            std::array<V,N> x;
+
+            // multi-block: N vectors of L samples per step
+            while (last - first >= static_cast<std::ptrdiff_t>(N*L)){
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n].load(&*(first + n*L));
+
+                x = permuteV(x);
+                _F.apply(x);
+                x = depermuteV(x);
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) _R(x[n]).store(&*(d_first + n*L));
+
+                first += N*L;
+                d_first += N*L;
+            }
+
+            // remainder: single vectors of L samples
+            V xv;
+
+            while (last - first >= L){
+
+                xv.load(&*first);
+                _R(_F(xv)).store(&*d_first);
+
+                first += L;
+                d_first += L;
+            }
+
+            // remainder: less than L samples
+            while (first != last){
+
+                *d_first = _R(_F(static_cast<T>(*first)));
+
+                first += 1;
+                d_first += 1;
+            }
+
+            return d_first;
+        };
+
+        // streaming: chunks may have any length, the recursion carries over between calls
+        inline void process(std::span<const T> chunk, std::span<T> out){ (*this)(chunk.begin(), chunk.end(), out.begin());};
+
+        inline void process(std::span<T> chunk){ (*this)(chunk.begin(), chunk.end(), chunk.begin());};
+
+};
+
+
+#endif // header guard
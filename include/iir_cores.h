@@ -4,6 +4,7 @@
 
 #include "../src/vcl/vectorclass.h"
 #include <array>
+#include <type_traits>
 
 #include "shift_reg.h"
 #include "ph_decompos.h"
@@ -12,17 +13,47 @@
 #include "block_filtering.h"
 #include "permute.h"
 
-template<typename V,size_t N> class IirCoreOrderTwo{
+// Algorithm of the multi-block path. With transposed = true the caller hands in lane-transposed blocks
+// (permuteV, once for the whole cascade), otherwise the blocks arrive in natural sample order.
+namespace algo{
+
+    // FIR, then cyclic reduction
+    struct CR{ constexpr static bool transposed = true; constexpr static const char* name = "CR";};
+
+    // FIR, particular solution, then homogeneous solution by recursive doubling
+    struct PH{ constexpr static bool transposed = true; constexpr static const char* name = "PH-RD";};
+
+    // block filtering, one vector of L samples after the other
+    struct Block{ constexpr static bool transposed = false; constexpr static const char* name = "block";};
+
+    // CR and PH-RD with every section transposing its own blocks
+    struct CR_T{ constexpr static bool transposed = false; constexpr static const char* name = "CR-T";};
+
+    struct PH_T{ constexpr static bool transposed = false; constexpr static const char* name = "PH-RD-T";};
+}
+
+
+// stands in for the sub-cores an algorithm doesn't use
+template<int> struct Unused{};
+
+
+// Each section starts on a cache line and keeps only what its three paths read. The multi-block path
+// (_F, _CR or _PSV/_HSV) comes first, so a cascade touches one contiguous run of lines per section in the hot loop.
+template<typename V,size_t N,typename A = algo::CR> class alignas(64) IirCoreOrderTwo{
 
     using T = decltype(std::declval<V>().extract(0));
     constexpr static int L = V::size(); 
 
+    constexpr static bool _uses_CR = std::is_same_v<A,algo::CR> || std::is_same_v<A,algo::CR_T>;
+    constexpr static bool _uses_PH = std::is_same_v<A,algo::PH> || std::is_same_v<A,algo::PH_T>;
+    constexpr static bool _uses_F = _uses_CR || _uses_PH;
+
     private:
 
-        PartSolutionV<V,N> _PSV;
-        HomoSolutionV<V,N> _HSV;
-        FirCoreOrderTwo<V,N> _F;
-        CyclicReduction<V,N> _CR;
+        [[no_unique_address]] std::conditional_t<_uses_F, FirCoreOrderTwo<V,N>, Unused<0>> _F;
+        [[no_unique_address]] std::conditional_t<_uses_CR, CyclicReduction<V,N>, Unused<1>> _CR;
+        [[no_unique_address]] std::conditional_t<_uses_PH, PartSolutionV<V,N>, Unused<2>> _PSV;
+        [[no_unique_address]] std::conditional_t<_uses_PH, HomoSolutionV<V,N>, Unused<3>> _HSV;
         BlockFiltering<V> _BF;
 
         Shift<V> _PS,_HS;
@@ -38,10 +69,13 @@ template<typename V,size_t N> class IirCoreOrderTwo{
         IirCoreOrderTwo(const T b1,const T b2,const T a1,const T a2,const T xi1=0,const T xi2=0,const T yi1=0,const T yi2=0):
         _b1(b1),_b2(b2),_a1(a1),_a2(a2){
  
-            _F = FirCoreOrderTwo<V,N>(b1,b2,xi1,xi2);
-            _PSV = PartSolutionV<V,N>(a1,a2); 
-            _HSV = HomoSolutionV<V,N>(a1,a2,yi1,yi2);
-            _CR = CyclicReduction<V,N>(a1,a2,yi1,yi2);
+            if constexpr (_uses_F) _F = FirCoreOrderTwo<V,N>(b1,b2,xi1,xi2);
+            if constexpr (_uses_CR) _CR = CyclicReduction<V,N>(a1,a2,yi1,yi2);
+            if constexpr (_uses_PH){
+
+                _PSV = PartSolutionV<V,N>(a1,a2); 
+                _HSV = HomoSolutionV<V,N>(a1,a2,yi1,yi2);
+            }
             _BF = BlockFiltering<V>(b1,b2,a1,a2,xi1,xi2,yi1,yi2);
 
             _PS.shift(xi2);
@@ -52,85 +86,439 @@ template<typename V,size_t N> class IirCoreOrderTwo{
 
         __attribute__((always_inline))
         IirCoreOrderTwo(const T taps[5],const T inits[4]):
-        _b1(taps[1]),_b2(taps[2]),_a1(taps[3]),_a2(taps[4]){
+        IirCoreOrderTwo(taps[1],taps[2],taps[3],taps[4],inits[0],inits[1],inits[2],inits[3]){};
+
+        __attribute__((always_inline))
+        inline T operator()(const T x){
+
+            T y = x + _b2*_PS[-2] + _b1*_PS[-1] + _a2*_HS[-2] + _a1*_HS[-1];
+
+            _PS.shift(x);
+            _HS.shift(y);
+
+            return y;
+        }
+
+        __attribute__((always_inline))
+        inline V operator()(const V x){
+
+            V y = _BF(x);
+
+            return y;
+        }
+
+        // multi-block path in place: FIR and CR share the caller's buffer, PH/RD still goes through temporaries
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+
+            if constexpr (std::is_same_v<A,algo::CR>){
+
+                _F.apply(x);
+                _CR.apply(x);
+            }
+            else if constexpr (std::is_same_v<A,algo::Block>){
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n] = _BF(x[n]);
+            }
+            else if constexpr (std::is_same_v<A,algo::CR_T>){
+
+                x = permuteV(x);
+                _F.apply(x);
+                _CR.apply(x);
+                x = depermuteV(x);
+            }
+            else x = (*this)(x);
+        }
+
+        __attribute__((always_inline))
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
+
+            if constexpr (std::is_same_v<A,algo::PH>){
+
+                auto v = _F(x);
+                auto w = _PSV(v);
+                auto y = _HSV(w);
+
+                return y;
+            }
+            else if constexpr (std::is_same_v<A,algo::PH_T>){
+
+                auto x_T = permuteV(x);
+                auto v = _F(x_T);
+                auto w = _PSV(v);
+                auto y_T = _HSV(w);
+                auto y = depermuteV(y_T);
+
+                return y;
+            }
+            else {
+
+                std::array<V,N> y = x;
+                apply(y);
+
+                return y;
+            }
+        }
+
+        // {xi1,xi2,yi1,yi2} left behind by the scalar (U = T), block (U = V) or multi-block (U = std::array<V,N>) path
+        template<typename U>
+        __attribute__((always_inline))
+        inline std::array<T,4> state(){
+
+            if constexpr (std::is_same_v<U,T>) 
+                return {_PS[-1],_PS[-2],_HS[-1],_HS[-2]};
+
+            else if constexpr (std::is_same_v<U,V> || !_uses_F) 
+                return _BF.state();
+
+            else {
+
+                auto xi = _F.state();
+                std::array<T,2> yi;
+
+                if constexpr (_uses_CR) yi = _CR.state();
+                else yi = _HSV.state();
 
-            _F = FirCoreOrderTwo<V,N>(taps[1],taps[2],inits[0],inits[1]);
-            _PSV = PartSolutionV<V,N>(taps[3],taps[4]); 
-            _HSV = HomoSolutionV<V,N>(taps[3],taps[4],inits[2],inits[3]);
-            _CR = CyclicReduction<V,N>(taps[3],taps[4],inits[2],inits[3]);
-            _BF = BlockFiltering<V>(taps[1],taps[2],taps[3],taps[4],inits[0],inits[1],inits[2],inits[3]);
+                return {xi[0],xi[1],yi[0],yi[1]};
+            }
+        }
+
+        __attribute__((always_inline))
+        inline void reset(const std::array<T,4>& inits){
+
+            if constexpr (_uses_F) _F.reset(inits[0],inits[1]);
+            if constexpr (_uses_CR) _CR.reset(inits[2],inits[3]);
+            if constexpr (_uses_PH) _HSV.reset(inits[2],inits[3]);
+            _BF.reset(inits[0],inits[1],inits[2],inits[3]);
 
             _PS.shift(inits[1]);
             _PS.shift(inits[0]);
             _HS.shift(inits[3]);
             _HS.shift(inits[2]);
+        }
+
+        // hand the state of path U over to the other paths, so that granularities can be mixed on one stream
+        template<typename U>
+        __attribute__((always_inline))
+        inline void sync(){ reset(state<U>());}
+
+};
+
+
+// First-order section y[n] = x[n] + b1*x[n-1] + a1*y[n-1], for the odd section of odd-order designs. Same
+// interface and coefficient row as IirCoreOrderTwo ({1,b1,0,a1,0}, inits {xi1,0,yi1,0}), at about half the FMAs:
+// every recursion is a first-order one, across the lanes a scalar prefix scan.
+template<typename V,size_t N,typename A = algo::CR> class alignas(64) IirCoreOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+
+    constexpr static bool _uses_CR = std::is_same_v<A,algo::CR> || std::is_same_v<A,algo::CR_T>;
+    constexpr static bool _uses_PH = std::is_same_v<A,algo::PH> || std::is_same_v<A,algo::PH_T>;
+    constexpr static bool _uses_F = _uses_CR || _uses_PH;
+
+    private:
+
+        [[no_unique_address]] std::conditional_t<_uses_F, FirCoreOrderOne<V,N>, Unused<0>> _F;
+        [[no_unique_address]] std::conditional_t<_uses_CR, CyclicReductionOrderOne<V,N>, Unused<1>> _CR;
+        [[no_unique_address]] std::conditional_t<_uses_PH, PartSolutionOrderOne<V,N>, Unused<2>> _PSV;
+        [[no_unique_address]] std::conditional_t<_uses_PH, HomoSolutionOrderOne<V,N>, Unused<3>> _HSV;
+        BlockFilteringOrderOne<V> _BF;
+
+        T _b1,_a1,_xi1,_yi1;
+
+    public:
+
+        IirCoreOrderOne(){};
+
+        __attribute__((always_inline))
+        IirCoreOrderOne(const T b1,const T a1,const T xi1=0,const T yi1=0): _b1(b1),_a1(a1),_xi1(xi1),_yi1(yi1){
+ 
+            if constexpr (_uses_F) _F = FirCoreOrderOne<V,N>(b1,xi1);
+            if constexpr (_uses_CR) _CR = CyclicReductionOrderOne<V,N>(a1,yi1);
+            if constexpr (_uses_PH){
+
+                _PSV = PartSolutionOrderOne<V,N>(a1); 
+                _HSV = HomoSolutionOrderOne<V,N>(a1,yi1);
+            }
+            _BF = BlockFilteringOrderOne<V>(b1,a1,xi1,yi1);
         };
 
+        // b2, a2 and xi2, yi2 of the row are ignored
+        __attribute__((always_inline))
+        IirCoreOrderOne(const T taps[5],const T inits[4]):
+        IirCoreOrderOne(taps[1],taps[3],inits[0],inits[2]){};
+
         __attribute__((always_inline))
         inline T operator()(const T x){
 
-            T y = x + _b2*_PS[-2] + _b1*_PS[-1] + _a2*_HS[-2] + _a1*_HS[-1];
+            T y = x + _b1*_xi1 + _a1*_yi1;
 
-            _PS.shift(x);
-            _HS.shift(y);
+            _xi1 = x;
+            _yi1 = y;
 
             return y;
         }
 
         __attribute__((always_inline))
-        inline V operator()(const V x){
+        inline V operator()(const V x){ return _BF(x);}
 
-            V y = _BF(x);
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+
+            if constexpr (std::is_same_v<A,algo::Block>){
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n] = _BF(x[n]);
+            }
+            else{
+
+                if constexpr (!A::transposed) x = permuteV(x);
+
+                _F.apply(x);
+
+                if constexpr (_uses_CR) _CR.apply(x);
+                else{
+
+                    _PSV.apply(x);
+                    _HSV.apply(x);
+                }
+
+                if constexpr (!A::transposed) x = depermuteV(x);
+            }
+        }
+
+        __attribute__((always_inline))
+        inline std::array<V,N> operator()(const std::array<V,N>& x){
+
+            std::array<V,N> y = x;
+            apply(y);
 
             return y;
         }
 
-        // __attribute__((always_inline))
-        // inline std::array<V,N> operator()(const std::array<V,N>& x){
+        // {xi1,0,yi1,0}, the layout of IirCoreOrderTwo::state
+        template<typename U>
+        __attribute__((always_inline))
+        inline std::array<T,4> state(){
+
+            if constexpr (std::is_same_v<U,T>) 
+                return {_xi1,0,_yi1,0};
+
+            else if constexpr (std::is_same_v<U,V> || !_uses_F){ 
+                
+                auto s = _BF.state();
+                return {s[0],0,s[1],0};
+            }
 
-        //     auto v = _F(x);
-        //     auto w = _PSV(v);
-        //     auto y = _HSV(w);
+            else {
 
-        //     return y;
-        // }
+                T yi1;
+
+                if constexpr (_uses_CR) yi1 = _CR.state();
+                else yi1 = _HSV.state();
+
+                return {_F.state(),0,yi1,0};
+            }
+        }
+
+        __attribute__((always_inline))
+        inline void reset(const std::array<T,4>& inits){
+
+            if constexpr (_uses_F) _F.reset(inits[0]);
+            if constexpr (_uses_CR) _CR.reset(inits[2]);
+            if constexpr (_uses_PH) _HSV.reset(inits[2]);
+            _BF.reset(inits[0],inits[2]);
+
+            _xi1 = inits[0];
+            _yi1 = inits[2];
+        }
+
+        template<typename U>
+        __attribute__((always_inline))
+        inline void sync(){ reset(state<U>());}
+
+};
+
+
+// Direct section of order K, y[n] = x[n] + sum_k bk*x[n-k] + sum_k ak*y[n-k], by PH decomposition with
+// companion-matrix recursive doubling (RecurDoublingOrderK). Row {1,b1..bK,a1..aK}, inits {xi1..xiK,yi1..yiK}.
+// One section of order 2K' replaces K' biquads and their Series passes, at K^2 FMAs per scan step. Only the PH
+// algorithms, transposed by the caller (algo::PH) or by the section (algo::PH_T); N >= K.
+template<typename V,size_t N,size_t K,typename A = algo::PH> class alignas(64) IirCoreOrderK{
+
+    static_assert(std::is_same_v<A,algo::PH> || std::is_same_v<A,algo::PH_T>, "order K sections run PH/RD only");
+    static_assert(N >= K, "the previous lane's tail must fit in one block");
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+
+    private:
+
+        FirCoreOrderK<V,N,K> _F;
+        PartSolutionOrderK<V,N,K> _PSV;
+        HomoSolutionOrderK<V,N,K> _HSV;
+
+        // one vector of L samples: companion matrix of a single step, the FIR from a buffer of K+L inputs
+        RecurDoublingOrderK<V,1,K> _RD1;
+        T _xb[K+L];
+
+        T _b[K],_a[K];
+
+        // x[-1..-K], y[-1..-K] of the scalar and block paths
+        std::array<T,K> _xi,_yi;
+
+    public:
+
+        IirCoreOrderK(){};
+
+        __attribute__((always_inline))
+        IirCoreOrderK(const T taps[2*K+1],const T inits[2*K]){
+
+            for (size_t k=0; k<K; k++){
+
+                _b[k] = taps[1+k];
+                _a[k] = taps[1+K+k];
+                _xi[k] = inits[k];
+                _yi[k] = inits[K+k];
+            }
+
+            _F = FirCoreOrderK<V,N,K>(_b,_xi);
+            _PSV = PartSolutionOrderK<V,N,K>(_a);
+            _HSV = HomoSolutionOrderK<V,N,K>(_a,_yi);
+            _RD1 = RecurDoublingOrderK<V,1,K>(_a);
+        };
+
+        __attribute__((always_inline))
+        inline T operator()(const T x){
+
+            T y = x;
+
+            for (size_t k=0; k<K; k++) y += _b[k]*_xi[k] + _a[k]*_yi[k];
+
+            for (size_t k=K-1; k>0; k--){ _xi[k] = _xi[k-1]; _yi[k] = _yi[k-1];}
+            _xi[0] = x;
+            _yi[0] = y;
+
+            return y;
+        }
+
+        __attribute__((always_inline))
+        inline V operator()(const V x){
+
+            for (size_t k=0; k<K; k++) _xb[K-1-k] = _xi[k];
+            x.store(&_xb[K]);
+
+            V y = x, xk;
+
+            #pragma unroll
+            for (size_t k=1; k<=K; k++){
+
+                xk.load(&_xb[K-k]);
+                y = mul_add(xk, _b[k-1], y);
+            }
+
+            for (size_t k=0; k<K; k++) _xi[k] = _xb[K+L-1-k];
+
+            // lane l of e[i] ends up holding y[l-i]
+            std::array<V,K> e;
+            e.fill(V(0));
+            e[0] = y;
+
+            _RD1.scan(e, _yi);
+
+            for (size_t k=0; k<K; k++) _yi[k] = e[k][L-1];
+
+            return e[0];
+        }
+
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& x){
+
+            if constexpr (!A::transposed) x = permuteV(x);
+
+            _F.apply(x);
+            _PSV.apply(x);
+            _HSV.apply(x);
+
+            if constexpr (!A::transposed) x = depermuteV(x);
+        }
 
         __attribute__((always_inline))
         inline std::array<V,N> operator()(const std::array<V,N>& x){
 
-            auto v = _F(x);
-            auto y = _CR(v);
+            std::array<V,N> y = x;
+            apply(y);
 
             return y;
         }
 
-        // __attribute__((always_inline))
-        // inline std::array<V,N> operator()(const std::array<V,N>& x){
+        // {xi1..xiK,yi1..yiK}, the scalar and block paths share one state
+        template<typename U>
+        __attribute__((always_inline))
+        inline std::array<T,2*K> state(){
 
-        //     auto x_T = permuteV(x);
-        //     auto v = _F(x_T);
-        //     auto w = _PSV(v);
-        //     auto y_T = _HSV(w);
-        //     auto y = depermuteV(y_T);
+            std::array<T,K> xi = _xi, yi = _yi;
 
-        //     return y;
-        // }
+            if constexpr (!std::is_same_v<U,T> && !std::is_same_v<U,V>){
 
-        // __attribute__((always_inline))
-        // inline std::array<V,N> operator()(const std::array<V,N>& x){
+                xi = _F.state();
+                yi = _HSV.state();
+            }
 
-        //     auto x_T = permuteV(x);
-        //     auto v = _F(x_T);
-        //     auto y_T = _CR(v);
-        //     auto y = depermuteV(y_T);
+            std::array<T,2*K> s;
+            for (size_t k=0; k<K; k++){ s[k] = xi[k]; s[K+k] = yi[k];}
 
-        //     return y;
-        // }
+            return s;
+        }
 
+        __attribute__((always_inline))
+        inline void reset(const std::array<T,2*K>& inits){
 
+            for (size_t k=0; k<K; k++){ _xi[k] = inits[k]; _yi[k] = inits[K+k];}
+
+            _F.reset(_xi);
+            _HSV.reset(_yi);
+        }
+
+        template<typename U>
+        __attribute__((always_inline))
+        inline void sync(){ reset(state<U>());}
 
 };
 
+
+// Multiplies out the M biquad rows {1,b1,b2,a1,a2} into the row {1,b1..bK,a1..aK} of one IirCoreOrderK, K = 2M
+template<typename T,size_t M>
+inline std::array<T,4*M+1> order_k_from_biquads(const T (&coefs)[M][5]){
+
+    constexpr size_t K = 2*M;
+
+    // numerator 1 + b1 z^-1 + ..., denominator 1 - a1 z^-1 - ...
+    std::array<T,K+1> num{}, den{};
+    num[0] = den[0] = 1;
+
+    for (size_t m=0; m<M; m++){
+
+        for (size_t k=2*m+2; k>=1; k--){
+
+            for (size_t i=1; i<=2 && i<=k; i++){
+
+                num[k] += coefs[m][i]*num[k-i];
+                den[k] -= coefs[m][2+i]*den[k-i];
+            }
+        }
+    }
+
+    std::array<T,4*M+1> taps;
+    taps[0] = 1;
+    for (size_t k=1; k<=K; k++){ taps[k] = num[k]; taps[K+k] = -den[k];}
+
+    return taps;
+}
+
+
 #endif
 
 
@@ -0,0 +1,102 @@
+#ifndef LANES_H
+#define LANES_H 1
+
+#include "../src/vcl/vectorclass.h"
+#include <utility>
+#include <type_traits>
+
+
+// Lane index lists for VCL's permuteN/blendN, generated for any lane count L from a constexpr
+// index function idx(L,s,l) over std::make_integer_sequence<int,L>. The expansion is the same
+// literal list that used to be written out per L, so each call is still one permute/blend.
+
+
+// lane l takes lane l-1, lane 0 is zeroed, <-1,0,1,...,L-2>
+constexpr int shift_up(int,int,int l){ return l-1;}
+
+// lane l takes lane l-1, lane 0 is kept, <0,0,1,...,L-2>
+constexpr int shift_up_dup(int,int,int l){ return l == 0 ? 0 : l-1;}
+
+// shift up by one and insert lane 0 of the second operand, <L,0,1,...,L-2>
+constexpr int shift_in(int L,int,int l){ return l == 0 ? L : l-1;}
+
+// shift down by one and insert lane 0 of the second operand on top, <1,2,...,L>
+constexpr int shift_down_in(int,int,int l){ return l+1;}
+
+// neighbours swapped, <1,0,3,2,...>: real and imaginary part of interleaved complex lanes
+constexpr int pair_swap(int,int,int l){ return l ^ 1;}
+
+// lanes in reverse order, <L-1,...,1,0>
+constexpr int lane_reverse(int L,int,int l){ return L-1-l;}
+
+// lane 0 of the second operand, then lane 0 of the first, <L,0,0,...,0>
+constexpr int first_in(int L,int,int l){ return l == 0 ? L : 0;}
+
+// recursive doubling step s >= 1: lanes with bit s-1 set take the last lane of the preceding 2^(s-1) group,
+// e.g. L = 8, s = 2: <-1,-1,1,1,-1,-1,5,5>
+constexpr int rd_broadcast(int,int s,int l){ return ((l >> (s-1)) & 1) ? ((l >> s) << s) + (1 << (s-1)) - 1 : -1;}
+
+// recursive doubling factors of step s: [C 0 ... 0] for s = 0, else C^1..C^(2^(s-1)) in the lanes with bit s-1 set,
+// e.g. L = 8, s = 2: <-1,-1,0,1,-1,-1,0,1>
+constexpr int rd_factor(int,int s,int l){ return s == 0 ? (l == 0 ? 0 : -1) : (((l >> (s-1)) & 1) ? (l & ((1 << (s-1)) - 1)) : -1);}
+
+
+template<typename V, int... i>
+__attribute__((always_inline))
+inline V permute_n(const V a){
+
+    constexpr int L = V::size();
+
+    if constexpr (L == 2) return permute2<i...>(a);
+    else if constexpr (L == 4) return permute4<i...>(a);
+    else if constexpr (L == 8) return permute8<i...>(a);
+    else if constexpr (L == 16) return permute16<i...>(a);
+    else if constexpr (L == 32) return permute32<i...>(a);
+    else static_assert(L == 2, "unsupported lane count");
+};
+
+
+template<typename V, int... i>
+__attribute__((always_inline))
+inline V blend_n(const V a, const V b){
+
+    constexpr int L = V::size();
+
+    if constexpr (L == 2) return blend2<i...>(a, b);
+    else if constexpr (L == 4) return blend4<i...>(a, b);
+    else if constexpr (L == 8) return blend8<i...>(a, b);
+    else if constexpr (L == 16) return blend16<i...>(a, b);
+    else if constexpr (L == 32) return blend32<i...>(a, b);
+    else static_assert(L == 2, "unsupported lane count");
+};
+
+
+template<typename V, int (*idx)(int,int,int), int s, int... l>
+__attribute__((always_inline))
+inline V _permute_lanes(const V a, std::integer_sequence<int,l...>){
+    return permute_n<V, idx(V::size(),s,l)...>(a);
+};
+
+template<typename V, int (*idx)(int,int,int), int s, int... l>
+__attribute__((always_inline))
+inline V _blend_lanes(const V a, const V b, std::integer_sequence<int,l...>){
+    return blend_n<V, idx(V::size(),s,l)...>(a, b);
+};
+
+
+// e.g. permute_lanes<shift_up>(x) is permute8<-1,0,1,2,3,4,5,6>(x) for Vec8f
+template<int (*idx)(int,int,int), int s=0, typename V>
+__attribute__((always_inline))
+inline V permute_lanes(const V a){
+    return _permute_lanes<V,idx,s>(a, std::make_integer_sequence<int,V::size()>{});
+};
+
+// the second operand may be a scalar, which VCL broadcasts
+template<int (*idx)(int,int,int), int s=0, typename V>
+__attribute__((always_inline))
+inline V blend_lanes(const V a, const std::type_identity_t<V> b){
+    return _blend_lanes<V,idx,s>(a, b, std::make_integer_sequence<int,V::size()>{});
+};
+
+
+#endif
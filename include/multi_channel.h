@@ -0,0 +1,181 @@
+#ifndef MULTI_CHANNEL_H
+#define MULTI_CHANNEL_H 1
+
+#include "../src/vcl/vectorclass.h"
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "permute.h"
+#include "prefetch.h"
+
+
+// Cascade of M biquads over many independent channels with identical coefficients.
+// One channel is mapped to one lane, so the recursion runs lane-wise and needs no
+// cyclic reduction or recursive doubling (no extra FMAs).
+template<typename V,size_t M> class MultiChannelFilter{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+
+    // x[n-1], x[n-2], y[n-1], y[n-2] of each section
+    using State_t = std::array<V,4*M>;
+
+    private:
+
+        size_t _C;
+
+        T _b1[M], _b2[M], _a1[M], _a2[M];
+
+        // one entry per group of L channels
+        std::vector<State_t> _state;
+
+        // software prefetch distance in samples of a channel, 0 leaves it to the hardware prefetcher
+        size_t _pf = 0;
+
+        __attribute__((always_inline))
+        inline V _proc(V x, State_t& s){
+
+            #pragma unroll
+            for (size_t m=0; m<M; m++){
+
+                V y = mul_add(s[4*m+1], _b2[m], x);
+                y = mul_add(s[4*m], _b1[m], y);
+                y = mul_add(s[4*m+3], _a2[m], y);
+                y = mul_add(s[4*m+2], _a1[m], y);
+
+                s[4*m+1] = s[4*m];
+                s[4*m] = x;
+                s[4*m+3] = s[4*m+2];
+                s[4*m+2] = y;
+
+                x = y;
+            }
+
+            return x;
+        }
+
+    public:
+
+        MultiChannelFilter(){};
+
+        MultiChannelFilter(const T (&coefs)[M][5], const T (&inits)[M][4], const size_t channels): _C(channels){
+
+            if (channels == 0) throw std::invalid_argument("MultiChannelFilter: channels must be positive");
+
+            State_t s;
+
+            for (size_t m=0; m<M; m++){
+
+                _b1[m] = coefs[m][1];
+                _b2[m] = coefs[m][2];
+                _a1[m] = coefs[m][3];
+                _a2[m] = coefs[m][4];
+
+                for (size_t i=0; i<4; i++) s[4*m+i] = V(inits[m][i]);
+            }
+
+            _state.assign((_C + L - 1)/L, s);
+        };
+
+        inline size_t channels() const { return _C;};
+
+        // prefetch distance in samples per channel, e.g. from the autotuner; 0 disables it. The strided
+        // streams of both layouts are where the hardware prefetcher falls behind.
+        inline void prefetch(const size_t distance){ _pf = distance;};
+
+        inline size_t prefetch() const { return _pf;};
+
+        // interleaved buffer, x[t*C + c]. Only whole frames of C samples are filtered: a trailing partial frame is
+        // left untouched and the returned iterator points to its output position, so it can lead the next chunk.
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt interleaved(InputIt first, InputIt last, OutputIt d_first){
+
+            const size_t S = (last - first)/_C;
+
+            for (size_t g=0; g<_state.size(); g++){
+
+                const size_t c = g*L;
+                const int nch = std::min<size_t>(L, _C - c);
+                State_t s = _state[g];
+                V x;
+
+                if (nch == L){
+                    for (size_t t=0; t<S; t++){
+
+                        if (_pf) prefetch_lines(&*(first + (t + std::min<size_t>(_pf, S-1-t))*_C + c), sizeof(V));
+
+                        x.load(&*(first + t*_C + c));
+                        _proc(x, s).store(&*(d_first + t*_C + c));
+                    }
+                }
+                else{
+                    for (size_t t=0; t<S; t++){
+
+                        if (_pf) prefetch_lines(&*(first + (t + std::min<size_t>(_pf, S-1-t))*_C + c), sizeof(V));
+
+                        x.load_partial(nch, &*(first + t*_C + c));
+                        _proc(x, s).store_partial(nch, &*(d_first + t*_C + c));
+                    }
+                }
+
+                _state[g] = s;
+            }
+
+            return d_first + S*_C;
+        };
+
+        // channel-major buffer, x[c*S + t]; L x L tiles are transposed so that lanes hold channels.
+        // S = (last - first)/C, the length must be a multiple of C, any excess samples are not filtered.
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt channel_major(InputIt first, InputIt last, OutputIt d_first){
+
+            const size_t S = (last - first)/_C;
+
+            for (size_t g=0; g<_state.size(); g++){
+
+                const size_t c = g*L;
+                const int nch = std::min<size_t>(L, _C - c);
+                State_t s = _state[g];
+                std::array<V,L> x{}, y_T;
+                size_t t = 0;
+
+                for (; t+L<=S; t+=L){
+
+                    if (_pf)
+                        for (int l=0; l<nch; l++) prefetch_lines(&*(first + (c+l)*S + t) + std::min<size_t>(_pf, S-t), sizeof(V));
+
+                    #pragma unroll
+                    for (int l=0; l<nch; l++) x[l].load(&*(first + (c+l)*S + t));
+
+                    auto x_T = permuteV(x);
+
+                    #pragma unroll
+                    for (int n=0; n<L; n++) y_T[n] = _proc(x_T[n], s);
+
+                    auto y = depermuteV(y_T);
+
+                    #pragma unroll
+                    for (int l=0; l<nch; l++) y[l].store(&*(d_first + (c+l)*S + t));
+                }
+
+                // remainder: less than L samples per channel, gathered lane by lane
+                for (; t<S; t++){
+
+                    V xv(0);
+                    for (int l=0; l<nch; l++) xv.insert(l, *(first + (c+l)*S + t));
+
+                    V yv = _proc(xv, s);
+                    for (int l=0; l<nch; l++) *(d_first + (c+l)*S + t) = yv[l];
+                }
+
+                _state[g] = s;
+            }
+
+            return d_first + S*_C;
+        };
+
+};
+
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef PARALLEL_FILTER_H
+#define PARALLEL_FILTER_H 1
+
+#include "iir_cores.h"
+#include "permute.h"
+#include "prefetch.h"
+#include <array>
+#include <span>
+#include <cmath>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+
+
+// The cascade of Filter in parallel form: H(z) = k + sum_m S_m(z), every S_m a biquad with the poles of section m,
+// all fed by the same input. The sections no longer wait on each other, so their FMA chains overlap; the price is
+// one copy and one add per section and block. The inits of the cascade are carried over as its zero-input response,
+// split by the same partial fractions into the yi1, yi2 of the sections.
+// Precondition: no two sections share a pole, otherwise the partial fractions don't exist. A cascade of repeated
+// sections is the common case that breaks it; the constructor throws std::invalid_argument when the system is
+// (near) singular. Close poles of different sections still pass but make the form ill-conditioned.
+template<typename V,size_t M,size_t N,typename A = algo::CR> class ParallelFilter{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+
+    // polynomials in z^-1 up to the order of the cascade
+    constexpr static size_t D = 2*M + 1;
+    using Poly = std::array<double,D>;
+    using Inits = T[M][4];
+
+    private:
+
+        std::array<IirCoreOrderTwo<V,N,A>,M> _S;
+
+        // direct term
+        T _k;
+
+        // software prefetch distance in samples, 0 leaves it to the hardware prefetcher
+        size_t _pf = 0;
+
+        __attribute__((always_inline))
+        inline static std::array<V,N> _in(const std::array<V,N>& x){
+            if constexpr (A::transposed) return permuteV(x); else return x;
+        };
+
+        __attribute__((always_inline))
+        inline static std::array<V,N> _out(const std::array<V,N>& y_T){
+            if constexpr (A::transposed) return depermuteV(y_T); else return y_T;
+        };
+
+        inline static void _mul(Poly& p, const double c1, const double c2){
+            for (size_t k=D-1; k>=1; k--) p[k] += c1*p[k-1] + (k >= 2 ? c2*p[k-2] : 0);
+        };
+
+        // Gaussian elimination with partial pivoting, column j of E multiplies u[j]
+        inline static std::array<double,D> _solve(std::array<Poly,D> E, Poly b){
+
+            double scale = 0;
+            for (const auto& e : E) for (const auto v : e) scale = std::max(scale, std::abs(v));
+
+            for (size_t c=0; c<D; c++){
+
+                size_t p = c;
+                for (size_t r=c+1; r<D; r++) if (std::abs(E[c][r]) > std::abs(E[c][p])) p = r;
+
+                // shared poles leave a zero pivot, up to rounding
+                if (!(std::abs(E[c][p]) > 1e-12*scale))
+                    throw std::invalid_argument("ParallelFilter: sections share a pole, no partial fraction form");
+
+                for (size_t j=0; j<D; j++) std::swap(E[j][c], E[j][p]);
+                std::swap(b[c], b[p]);
+
+                for (size_t r=c+1; r<D; r++){
+
+                    const double f = E[c][r]/E[c][c];
+                    for (size_t j=c; j<D; j++) E[j][r] -= f*E[j][c];
+                    b[r] -= f*b[c];
+                }
+            }
+
+            std::array<double,D> u;
+
+            for (size_t c=D; c-- > 0; ){
+
+                double s = b[c];
+                for (size_t j=c+1; j<D; j++) s -= E[j][c]*u[j];
+                u[c] = s/E[c][c];
+            }
+
+            return u;
+        };
+
+    public:
+
+        ParallelFilter(){};
+
+        // the rows of Filter, {1,b1,b2,a1,a2} per section, from rest
+        ParallelFilter(const T (&coefs)[M][5]): ParallelFilter(coefs, Inits{}){};
+
+        // the rows and inits of Filter, {xi1,xi2,yi1,yi2} per section of the cascade
+        ParallelFilter(const T (&coefs)[M][5], const T (&inits)[M][4]){
+
+            // B = prod (1 + b1 z^-1 + b2 z^-2) = k*prod D_n + sum_m (c0 + c1 z^-1)*prod_{n != m} D_n,
+            // D_n = 1 - a1 z^-1 - a2 z^-2, solved for u = {k, c0 of 0, c1 of 0, c0 of 1, ...}
+            Poly B{}, P{};
+            std::array<Poly,D> E{};
+
+            B[0] = P[0] = 1;
+
+            for (size_t m=0; m<M; m++){
+
+                _mul(B, coefs[m][1], coefs[m][2]);
+                _mul(P, -coefs[m][3], -coefs[m][4]);
+            }
+
+            E[0] = P;
+
+            for (size_t m=0; m<M; m++){
+
+                Poly Q{};
+                Q[0] = 1;
+                for (size_t n=0; n<M; n++) if (n != m) _mul(Q, -coefs[n][3], -coefs[n][4]);
+
+                E[1+2*m] = Q;
+                for (size_t k=1; k<D; k++) E[2+2*m][k] = Q[k-1];
+            }
+
+            const auto u = _solve(E, B);
+
+            // the zero-input response of the cascade is C/P with C = P*y up to z^-(2M-1), the same system splits
+            // it into sum_m (r0 + r1 z^-1)/D_m, and a section gives that from yi1 = r1/a2, yi2 = (r0 - a1*yi1)/a2
+            Poly y{}, C{};
+
+            for (size_t m=0; m<M; m++){
+
+                double xi1 = inits[m][0], xi2 = inits[m][1], yi1 = inits[m][2], yi2 = inits[m][3];
+
+                for (size_t n=0; n<D-1; n++){
+
+                    const double out = y[n] + coefs[m][1]*xi1 + coefs[m][2]*xi2 + coefs[m][3]*yi1 + coefs[m][4]*yi2;
+                    xi2 = xi1; xi1 = y[n];
+                    yi2 = yi1; yi1 = out;
+                    y[n] = out;
+                }
+            }
+
+            for (size_t n=0; n<D-1; n++) for (size_t k=0; k<=n; k++) C[n] += P[k]*y[n-k];
+
+            const auto r = _solve(E, C);
+
+            // (c0 + c1 z^-1)/D_m = (1 + b1 z^-1 + b2 z^-2)/D_m + d with d = c0 - 1, so the sections keep b0 = 1
+            // and every d joins the direct term
+            double k = u[0];
+
+            for (size_t m=0; m<M; m++){
+
+                const double a1 = coefs[m][3], a2 = coefs[m][4];
+                const double d = u[1+2*m] - 1;
+
+                // a2 != 0 here, otherwise P is a combination of the columns of section m and _solve throws
+                const double yi1 = r[2+2*m]/a2;
+                const double yi2 = (r[1+2*m] - a1*yi1)/a2;
+
+                _S[m] = IirCoreOrderTwo<V,N,A>(u[2+2*m] + d*a1, d*a2, a1, a2, 0, 0, yi1, yi2);
+                k += d;
+            }
+
+            _k = k;
+        };
+
+        template<typename InputIt, typename OutputIt>
+        __attribute__((always_inline))
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first) {
+
+            std::array<V,N> x, t, y;
+
+            // multi-block: every section filters its own copy of the block, the sums don't depend on each other
+            while (last - first >= static_cast<std::ptrdiff_t>(N*L)){
+
+                if (_pf) prefetch_lines(&*first + std::min<size_t>(_pf, last - first), N*L*sizeof(T));
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) x[n].load(&*(first + n*L));
+
+                x = _in(x);
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) y[n] = x[n]*_k;
+
+                #pragma unroll
+                for (size_t m=0; m<M; m++){
+
+                    t = x;
+                    _S[m].apply(t);
+
+                    #pragma unroll
+                    for (size_t n=0; n<N; n++) y[n] += t[n];
+                }
+
+                y = _out(y);
+
+                #pragma unroll
+                for (size_t n=0; n<N; n++) y[n].store(&*(d_first + n*L));
+
+                first += N*L;
+                d_first += N*L;
+            }
+
+            for (auto& s : _S) s.template sync<std::array<V,N>>();
+
+            // remainder: single vectors of L samples
+            V xv, yv;
+
+            while (last - first >= L){
+
+                xv.load(&*first);
+                yv = xv*_k;
+                for (auto& s : _S) yv += s(xv);
+                yv.store(&*d_first);
+
+                first += L;
+                d_first += L;
+            }
+
+            for (auto& s : _S) s.template sync<V>();
+
+            // remainder: less than L samples
+            while (first != last){
+
+                const T xs = *first;
+                T ys = xs*_k;
+                for (auto& s : _S) ys += s(xs);
+                *d_first = ys;
+
+                first += 1;
+                d_first += 1;
+            }
+
+            for (auto& s : _S) s.template sync<T>();
+
+            return d_first;
+        };
+
+        // prefetch distance of the block loop in samples, 0 disables it
+        inline void prefetch(const size_t distance){ _pf = distance;};
+
+        inline size_t prefetch() const { return _pf;};
+
+        // streaming: chunks may have any length, the recursion carries over between calls
+        inline void process(std::span<const T> chunk, std::span<T> out){ (*this)(chunk.begin(), chunk.end(), out.begin());};
+
+        inline void process(std::span<T> chunk){ (*this)(chunk.begin(), chunk.end(), chunk.begin());};
+
+};
+
+
+#endif // header guard
@@ -8,40 +8,17 @@
 
 template<typename V,size_t N> 
 __attribute__((always_inline))
-inline std::array<V,N> permuteV(const std::array<V,N>& matrix) {
-
-    std::array<V,N> matrix_T{};
-
-    // SSE
-    if constexpr (V::size() == 4) permuteV4<V,N>(matrix.data(), matrix_T.data());
-
-    // AVX2
-    if constexpr (V::size() == 8) permuteV8<V,N>(matrix.data(), matrix_T.data());
-
-    // AVX512
-    if constexpr (V::size() == 16) permuteV16<V,N>(matrix.data(), matrix_T.data());
-    
-    return matrix_T;
-};
-
-
-template<typename V,size_t N> 
-__attribute__((always_inline))
-inline std::array<V,N> depermuteV(const std::array<V,N>& matrix_T) {
-
-    std::array<V,N> matrix{};
+inline void permuteV2(const V* matrix,V* matrix_T){
 
-    // SSE
-    if constexpr (V::size() == 4) depermuteV4<V,N>(matrix_T.data(), matrix.data());
+    // swap bottom left and top right in matrix size L x N
+    #pragma unroll
+    for (size_t n=0;n<N/2;n++){
 
-    // AVX2
-    if constexpr (V::size() == 8) depermuteV8<V,N>(matrix_T.data(), matrix.data());
+        matrix_T[2*n] = blend2<0,2>(matrix[n],matrix[n+N/2]);
+        matrix_T[2*n+1] = blend2<1,3>(matrix[n],matrix[n+N/2]);
+    }
 
-    // AVX512
-    if constexpr (V::size() == 16) depermuteV16<V,N>(matrix_T.data(), matrix.data());
-    
-    return matrix;
-};
+}
 
 
 template<typename V,size_t N> 
@@ -145,6 +122,21 @@ inline void permuteV16(const V* matrix,V* matrix_T){
 }
 
 
+template<typename V,size_t N> 
+__attribute__((always_inline))
+inline void depermuteV2(const V* matrix_T,V* matrix){
+
+    // swap bottom left and top right in sub-matrix size L x L
+    #pragma unroll
+    for (size_t n=0;n<N/2;n++){
+
+        matrix[n] = blend2<0,2>(matrix_T[2*n],matrix_T[2*n+1]);
+        matrix[n+N/2] = blend2<1,3>(matrix_T[2*n],matrix_T[2*n+1]);
+    }
+
+}
+
+
 template<typename V,size_t N> 
 __attribute__((always_inline))
 inline void depermuteV4(const V* matrix_T,V* matrix){
@@ -273,6 +265,51 @@ inline void depermuteV16(const V* matrix_T,V* matrix){
 
 
 
+// after the per-L transposes, which are not found by ADL once VCL lives in its own VCL_NAMESPACE
+template<typename V,size_t N> 
+__attribute__((always_inline))
+inline std::array<V,N> permuteV(const std::array<V,N>& matrix) {
+
+    std::array<V,N> matrix_T{};
+
+    // SSE double
+    if constexpr (V::size() == 2) permuteV2<V,N>(matrix.data(), matrix_T.data());
+
+    // SSE
+    if constexpr (V::size() == 4) permuteV4<V,N>(matrix.data(), matrix_T.data());
+
+    // AVX2
+    if constexpr (V::size() == 8) permuteV8<V,N>(matrix.data(), matrix_T.data());
+
+    // AVX512
+    if constexpr (V::size() == 16) permuteV16<V,N>(matrix.data(), matrix_T.data());
+    
+    return matrix_T;
+};
+
+
+template<typename V,size_t N> 
+__attribute__((always_inline))
+inline std::array<V,N> depermuteV(const std::array<V,N>& matrix_T) {
+
+    std::array<V,N> matrix{};
+
+    // SSE double
+    if constexpr (V::size() == 2) depermuteV2<V,N>(matrix_T.data(), matrix.data());
+
+    // SSE
+    if constexpr (V::size() == 4) depermuteV4<V,N>(matrix_T.data(), matrix.data());
+
+    // AVX2
+    if constexpr (V::size() == 8) depermuteV8<V,N>(matrix_T.data(), matrix.data());
+
+    // AVX512
+    if constexpr (V::size() == 16) depermuteV16<V,N>(matrix_T.data(), matrix.data());
+    
+    return matrix;
+};
+
+
 #endif
 
 
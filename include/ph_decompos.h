@@ -5,7 +5,9 @@
 #include <array>
 #include "recursive_doubling.h"
 #include "shift_reg.h"
+#include "lanes.h"
 #include <tuple>
+#include <algorithm>
 
 
 template<typename V,size_t N> class PartSolutionV{
@@ -73,29 +75,9 @@ template<typename V,size_t N> class HomoSolutionV{
         inline std::array<V,N> forward(const std::array<V,N>& w,const V yv1,const V yv2){
 
             std::array<V,N> y;
-            V yvi1,yvi2;
+            V yvi2 = blend_lanes<shift_in>(yv2, _S[-2]);
+            V yvi1 = blend_lanes<shift_in>(yv1, _S[-1]);
 
-            // SSE
-            if constexpr (L == 4){
-
-                yvi2 = blend4<4,0,1,2>(yv2, _S[-2]);
-                yvi1 = blend4<4,0,1,2>(yv1, _S[-1]);
-            }
-
-            // AVX2
-            if constexpr (L == 8){
-
-                yvi2 = blend8<8,0,1,2,3,4,5,6>(yv2, _S[-2]);
-                yvi1 = blend8<8,0,1,2,3,4,5,6>(yv1, _S[-1]);
-            }
-
-            // AVX512
-            if constexpr (L == 16){
-
-                yvi2 = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(yv2, _S[-2]);
-                yvi1 = blend16<16,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14>(yv1, _S[-1]);
-            }
-            
             #pragma unroll
             for (auto n=0; n<N-2; n++){
 
@@ -124,6 +106,163 @@ template<typename V,size_t N> class HomoSolutionV{
 
         }
 
+        inline void reset(const T yi1,const T yi2){ _S.shift(yi2); _S.shift(yi1);};
+
+        inline std::array<T,2> state(){ return {_S[-1],_S[-2]};};
+
+};
+
+
+// first order: w[n] = v[n] + a1*w[n-1] in every lane from zero, one FMA per vector
+template<typename V,size_t N> class PartSolutionOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+
+    private:
+
+        T _a1;
+
+    public:
+
+        PartSolutionOrderOne(){};
+
+        PartSolutionOrderOne(const T a1): _a1(a1){};
+
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& w){
+
+            #pragma unroll
+            for (size_t n=1;n<N;n++) w[n] = mul_add(w[n-1],_a1,w[n]);
+        }
+
+};
+
+
+// first order: the last values of the lanes by a scalar prefix scan across the lanes, then y[n] = w[n] + a1^(n+1)*y[-1]
+// with y[-1] the last value of the previous lane, one FMA per vector
+template<typename V,size_t N> class HomoSolutionOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+
+    private:
+
+        T _h1[N];
+        RecurDoublingOrderOne<V> _RD;
+        Shift<V> _S;
+
+    public:
+
+        HomoSolutionOrderOne(){};
+
+        HomoSolutionOrderOne(const T a1,const T yi1=0){
+
+            _h1[0] = a1;
+            for (size_t n=1; n<N; n++) _h1[n] = a1*_h1[n-1];
+
+            _RD = RecurDoublingOrderOne<V>(_h1[N-1]); 
+            _S.shift(yi1);
+        };
+
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& w){
+
+            w[N-1] = _RD.scan(w[N-1], _S[-1]);
+
+            V yvi1 = blend_lanes<shift_in>(w[N-1], _S[-1]);
+
+            #pragma unroll
+            for (size_t n=0; n<N-1; n++) w[n] = mul_add(yvi1, _h1[n], w[n]);
+
+            _S.shift(w[N-1][L-1]); 
+        }
+
+        inline void reset(const T yi1){ _S.shift(yi1);};
+
+        inline T state(){ return _S[-1];};
+
+};
+
+
+// order K: w[n] = v[n] + a1*w[n-1] + ... + aK*w[n-K] in every lane from zero
+template<typename V,size_t N,size_t K> class PartSolutionOrderK{
+
+    using T = decltype(std::declval<V>().extract(0));
+
+    private:
+
+        T _a[K];
+
+    public:
+
+        PartSolutionOrderK(){};
+
+        PartSolutionOrderK(const T (&a)[K]){ for (size_t k=0; k<K; k++) _a[k] = a[k];};
+
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& w){
+
+            #pragma unroll
+            for (size_t n=1;n<N;n++)
+                #pragma unroll
+                for (size_t k=1; k<=std::min(n,K); k++) w[n] = mul_add(w[n-k],_a[k-1],w[n]);
+        }
+
+};
+
+
+// order K: the last K values of the lanes by recursive doubling with the companion matrix, then
+// y[n] = w[n] + sum_j h_j[n]*y[-1-j] with y[-1-j] from the previous lane, K FMAs per vector
+template<typename V,size_t N,size_t K> class HomoSolutionOrderK{
+
+    static_assert(N >= K, "the last K values of a lane must lie in one block");
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+
+    private:
+
+        RecurDoublingOrderK<V,N,K> _RD;
+
+        // y[-1], ..., y[-K]
+        std::array<T,K> _yi;
+
+    public:
+
+        HomoSolutionOrderK(){};
+
+        HomoSolutionOrderK(const T (&a)[K],const std::array<T,K>& yi = {}): _RD(a), _yi(yi){};
+
+        __attribute__((always_inline))
+        inline void apply(std::array<V,N>& w){
+
+            std::array<V,K> e, yvi;
+
+            #pragma unroll
+            for (size_t i=0; i<K; i++) e[i] = w[N-1-i];
+
+            _RD.scan(e, _yi);
+
+            #pragma unroll
+            for (size_t j=0; j<K; j++){
+
+                yvi[j] = blend_lanes<shift_in>(e[j], _yi[j]);
+                _yi[j] = e[j][L-1];
+            }
+
+            #pragma unroll
+            for (size_t n=0; n+K<N; n++)
+                #pragma unroll
+                for (size_t j=0; j<K; j++) w[n] = mul_add(yvi[j], _RD._h[j][n], w[n]);
+
+            #pragma unroll
+            for (size_t i=0; i<K; i++) w[N-1-i] = e[i];
+        }
+
+        inline void reset(const std::array<T,K>& yi){ _yi = yi;};
+
+        inline std::array<T,K> state(){ return _yi;};
+
 };
 
 
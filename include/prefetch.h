@@ -0,0 +1,21 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H 1
+
+#include "../src/vcl/vectorclass.h"
+#include <cstddef>
+#include <cstdint>
+
+
+// Software prefetch of the cache lines covering [p, p + bytes) into L1. The prefetch itself never faults, but
+// a pointer formed outside its buffer (other than one past the end) is undefined behaviour: callers clamp the
+// distance to the samples left in the range, and the lines past p are addressed as integers.
+__attribute__((always_inline))
+inline void prefetch_lines(const void* p, const size_t bytes){
+
+    const std::uintptr_t a = reinterpret_cast<std::uintptr_t>(p);
+
+    for (size_t b=0; b<bytes; b+=64) _mm_prefetch(reinterpret_cast<const char*>(a + b), _MM_HINT_T0);
+};
+
+
+#endif
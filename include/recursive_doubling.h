@@ -4,8 +4,11 @@
 #include "../src/vcl/vectorclass.h"
 #include <array>
 #include "ph_decompos.h"
+#include "lanes.h"
 #include <algorithm>
 #include <tuple>
+#include <utility>
+#include <bit>  // c++20
 
 #include <iostream>
 
@@ -14,6 +17,7 @@ template<typename V,size_t N> class RecurDoubling{
 
     using T = decltype(std::declval<V>().extract(0));
     constexpr static int L = V::size(); 
+    constexpr static int S = std::bit_width(unsigned(L))-1; // recursion steps
 
     private:
 
@@ -22,11 +26,8 @@ template<typename V,size_t N> class RecurDoubling{
 
         V _h_22, _h_12, _h_21, _h_11;
 
-        V _rd0_22, _rd0_12, _rd0_21, _rd0_11; 
-        V _rd1_22, _rd1_12, _rd1_21, _rd1_11; 
-        V _rd2_22, _rd2_12, _rd2_21, _rd2_11;
-        V _rd3_22, _rd3_12, _rd3_21, _rd3_11;
-        V _rd4_22, _rd4_12, _rd4_21, _rd4_11;
+        // _rd[0] = [C 0 ... 0], _rd[s] = C^1..C^(2^(s-1)) in the lanes with bit s-1 set
+        std::array<V,S+1> _rd_22, _rd_12, _rd_21, _rd_11;
 
         template<typename,size_t> friend class HomoSolutionV;
 
@@ -41,107 +42,37 @@ template<typename V,size_t N> class RecurDoubling{
             recursive_doubling_factors();
         };
 
+        // step s: lanes with bit s-1 set take the last lane of the preceding 2^(s-1) group,
+        // e.g. L = 8: <-1,0,-1,2,-1,4,-1,6>, <-1,-1,1,1,-1,-1,5,5>, <-1,-1,-1,-1,3,3,3,3>
+        template<int s>
+        __attribute__((always_inline))
+        inline void recursion(V& yv1, V& yv2){
+
+            V tmp2 = permute_lanes<rd_broadcast,s>(yv2);
+            V tmp1 = permute_lanes<rd_broadcast,s>(yv1);
+
+            yv2 = mul_add(tmp2, _rd_22[s], yv2);
+            yv1 = mul_add(tmp2, _rd_21[s], yv1);
+            yv2 = mul_add(tmp1, _rd_12[s], yv2);
+            yv1 = mul_add(tmp1, _rd_11[s], yv1);
+        }
+
         inline std::tuple<V,V> block_recursive_doubling(const V wv1,const V wv2,const T yi1,const T yi2){
 
-            V yv1,yv2,tmp1,tmp2;
+            V yv1,yv2;
 
             // step 1: initialization
-            yv2 = mul_add(yi2, _rd0_22, wv2);
-            yv1 = mul_add(yi2, _rd0_21, wv1);
-            yv2 = mul_add(yi1, _rd0_12, yv2);
-            yv1 = mul_add(yi1, _rd0_11, yv1);
-
-            // SSE
-            if constexpr (L == 4){
-
-                // step 2: first recursion
-                tmp2 = permute4<-1,0,-1,2>(yv2);
-                tmp1 = permute4<-1,0,-1,2>(yv1);
-
-                yv2 = mul_add(tmp2, _rd1_22, yv2);
-                yv1 = mul_add(tmp2, _rd1_21, yv1);
-                yv2 = mul_add(tmp1, _rd1_12, yv2);
-                yv1 = mul_add(tmp1, _rd1_11, yv1);
-
-                // step 3: second recursion
-                tmp2 = permute4<-1,-1,1,1>(yv2);
-                tmp1 = permute4<-1,-1,1,1>(yv1);
-
-                yv2 = mul_add(tmp2, _rd2_22, yv2);
-                yv1 = mul_add(tmp2, _rd2_21, yv1);
-                yv2 = mul_add(tmp1, _rd2_12, yv2);
-                yv1 = mul_add(tmp1, _rd2_11, yv1);
-            };
-
-            // AVX2
-            if constexpr (L == 8){ 
-                // step 2: first recursion
-                tmp2 = permute8<-1,0,-1,2,-1,4,-1,6>(yv2);
-                tmp1 = permute8<-1,0,-1,2,-1,4,-1,6>(yv1);
-
-                yv2 = mul_add(tmp2, _rd1_22, yv2);
-                yv1 = mul_add(tmp2, _rd1_21, yv1);
-                yv2 = mul_add(tmp1, _rd1_12, yv2);
-                yv1 = mul_add(tmp1, _rd1_11, yv1);
-
-                // step 3: second recursion
-                tmp2 = permute8<-1,-1,1,1,-1,-1,5,5>(yv2);
-                tmp1 = permute8<-1,-1,1,1,-1,-1,5,5>(yv1);
-
-                yv2 = mul_add(tmp2, _rd2_22, yv2);
-                yv1 = mul_add(tmp2, _rd2_21, yv1);
-                yv2 = mul_add(tmp1, _rd2_12, yv2);
-                yv1 = mul_add(tmp1, _rd2_11, yv1);
-
-                // step 4: third recursion
-                tmp2 = permute8<-1,-1,-1,-1,3,3,3,3>(yv2);
-                tmp1 = permute8<-1,-1,-1,-1,3,3,3,3>(yv1);
-
-                yv2 = mul_add(tmp2, _rd3_22, yv2);
-                yv1 = mul_add(tmp2, _rd3_21, yv1);
-                yv2 = mul_add(tmp1, _rd3_12, yv2);
-                yv1 = mul_add(tmp1, _rd3_11, yv1);
-            };
-
-            // AVX512
-            if constexpr (L == 16){ 
-                // step 2: first recursion
-                tmp2 = permute16<-1,0,-1,2,-1,4,-1,6,-1,8,-1,10,-1,12,-1,14>(yv2);
-                tmp1 = permute16<-1,0,-1,2,-1,4,-1,6,-1,8,-1,10,-1,12,-1,14>(yv1);
-
-                yv2 = mul_add(tmp2, _rd1_22, yv2);
-                yv1 = mul_add(tmp2, _rd1_21, yv1);
-                yv2 = mul_add(tmp1, _rd1_12, yv2);
-                yv1 = mul_add(tmp1, _rd1_11, yv1);
-
-                // step 3: second recursion
-                tmp2 = permute16<-1,-1,1,1,-1,-1,5,5,-1,-1,9,9,-1,-1,13,13>(yv2);
-                tmp1 = permute16<-1,-1,1,1,-1,-1,5,5,-1,-1,9,9,-1,-1,13,13>(yv1);
-
-                yv2 = mul_add(tmp2, _rd2_22, yv2);
-                yv1 = mul_add(tmp2, _rd2_21, yv1);
-                yv2 = mul_add(tmp1, _rd2_12, yv2);
-                yv1 = mul_add(tmp1, _rd2_11, yv1);
-
-                // step 4: third recursion
-                tmp2 = permute16<-1,-1,-1,-1,3,3,3,3,-1,-1,-1,-1,11,11,11,11>(yv2);
-                tmp1 = permute16<-1,-1,-1,-1,3,3,3,3,-1,-1,-1,-1,11,11,11,11>(yv1);
-
-                yv2 = mul_add(tmp2, _rd3_22, yv2);
-                yv1 = mul_add(tmp2, _rd3_21, yv1);
-                yv2 = mul_add(tmp1, _rd3_12, yv2);
-                yv1 = mul_add(tmp1, _rd3_11, yv1);
-
-                // step 4: fourth recursion
-                tmp2 = permute16<-1,-1,-1,-1,-1,-1,-1,-1,7,7,7,7,7,7,7,7>(yv2);
-                tmp1 = permute16<-1,-1,-1,-1,-1,-1,-1,-1,7,7,7,7,7,7,7,7>(yv1);
-
-                yv2 = mul_add(tmp2, _rd4_22, yv2);
-                yv1 = mul_add(tmp2, _rd4_21, yv1);
-                yv2 = mul_add(tmp1, _rd4_12, yv2);
-                yv1 = mul_add(tmp1, _rd4_11, yv1);
-            };
+            yv2 = mul_add(yi2, _rd_22[0], wv2);
+            yv1 = mul_add(yi2, _rd_21[0], wv1);
+            yv2 = mul_add(yi1, _rd_12[0], yv2);
+            yv1 = mul_add(yi1, _rd_11[0], yv1);
+
+            // steps 2 .. log2(L)+1: recursion
+            [&]<int... s>(std::integer_sequence<int,s...>){
 
+                (recursion<s+1>(yv1, yv2), ...);
+
+            }(std::make_integer_sequence<int,S>{});
 
             return {yv1,yv2};
         }
@@ -194,92 +125,174 @@ template<typename V,size_t N> class RecurDoubling{
 
             C_factors();
 
-            // SSE
-            if constexpr (L == 4){
-
-                // RD initialization, [C 0 0 0]
-                _rd0_22 = permute4<0,-1,-1,-1>(_h_22); 
-                _rd0_12 = permute4<0,-1,-1,-1>(_h_12);
-                _rd0_21 = permute4<0,-1,-1,-1>(_h_21);
-                _rd0_11 = permute4<0,-1,-1,-1>(_h_11);
-
-                // RD recursion 1, [0 C 0 C]
-                _rd1_22 = permute4<-1,0,-1,0>(_h_22);
-                _rd1_12 = permute4<-1,0,-1,0>(_h_12);
-                _rd1_21 = permute4<-1,0,-1,0>(_h_21);
-                _rd1_11 = permute4<-1,0,-1,0>(_h_11);
-
-                // RD recursion 2, [0 0 C C^2]
-                _rd2_22 = permute4<-1,-1,0,1>(_h_22);
-                _rd2_12 = permute4<-1,-1,0,1>(_h_12);
-                _rd2_21 = permute4<-1,-1,0,1>(_h_21);
-                _rd2_11 = permute4<-1,-1,0,1>(_h_11);
-            };
-
-            // AVX2
-            if constexpr (L == 8){
-
-                // RD initialization, [C 0 0 0 0 0 0 0]
-                _rd0_22 = permute8<0,-1,-1,-1,-1,-1,-1,-1>(_h_22); 
-                _rd0_12 = permute8<0,-1,-1,-1,-1,-1,-1,-1>(_h_12);
-                _rd0_21 = permute8<0,-1,-1,-1,-1,-1,-1,-1>(_h_21);
-                _rd0_11 = permute8<0,-1,-1,-1,-1,-1,-1,-1>(_h_11);
-
-                // RD recursion 1, [0 C 0 C 0 C 0 C]
-                _rd1_22 = permute8<-1,0,-1,0,-1,0,-1,0>(_h_22);
-                _rd1_12 = permute8<-1,0,-1,0,-1,0,-1,0>(_h_12);
-                _rd1_21 = permute8<-1,0,-1,0,-1,0,-1,0>(_h_21);
-                _rd1_11 = permute8<-1,0,-1,0,-1,0,-1,0>(_h_11);
-
-                // RD recursion 2, [0 0 C C^2 0 0 C C^2]
-                _rd2_22 = permute8<-1,-1,0,1,-1,-1,0,1>(_h_22);
-                _rd2_12 = permute8<-1,-1,0,1,-1,-1,0,1>(_h_12);
-                _rd2_21 = permute8<-1,-1,0,1,-1,-1,0,1>(_h_21);
-                _rd2_11 = permute8<-1,-1,0,1,-1,-1,0,1>(_h_11);
-
-                // RD recursion 3, [0 0 0 0 C C^2 C^3 C^4]
-                _rd3_22 = permute8<-1,-1,-1,-1,0,1,2,3>(_h_22);
-                _rd3_12 = permute8<-1,-1,-1,-1,0,1,2,3>(_h_12);
-                _rd3_21 = permute8<-1,-1,-1,-1,0,1,2,3>(_h_21);
-                _rd3_11 = permute8<-1,-1,-1,-1,0,1,2,3>(_h_11);
-            };
-
-            // AVX512
-            if constexpr (L == 16){
-
-                // RD initialization, [C 0 0 ... 0]
-                _rd0_22 = permute16<0,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1>(_h_22); 
-                _rd0_12 = permute16<0,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1>(_h_12);
-                _rd0_21 = permute16<0,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1>(_h_21);
-                _rd0_11 = permute16<0,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1>(_h_11);
-
-                // RD recursion 1, [0 C 0 C ... 0 C]
-                _rd1_22 = permute16<-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0>(_h_22);
-                _rd1_12 = permute16<-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0>(_h_12);
-                _rd1_21 = permute16<-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0>(_h_21);
-                _rd1_11 = permute16<-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0,-1,0>(_h_11);
-
-                // RD recursion 2, [0 0 C C^2 0 0 C C^2 ... 0 0 C C^2]
-                _rd2_22 = permute16<-1,-1,0,1,-1,-1,0,1,-1,-1,0,1,-1,-1,0,1>(_h_22);
-                _rd2_12 = permute16<-1,-1,0,1,-1,-1,0,1,-1,-1,0,1,-1,-1,0,1>(_h_12);
-                _rd2_21 = permute16<-1,-1,0,1,-1,-1,0,1,-1,-1,0,1,-1,-1,0,1>(_h_21);
-                _rd2_11 = permute16<-1,-1,0,1,-1,-1,0,1,-1,-1,0,1,-1,-1,0,1>(_h_11);
-
-                // RD recursion 3, [0 0 0 0 C C^2 C^3 C^4 0 0 0 0 C C^2 C^3 C^4]
-                _rd3_22 = permute16<-1,-1,-1,-1,0,1,2,3,-1,-1,-1,-1,0,1,2,3>(_h_22);
-                _rd3_12 = permute16<-1,-1,-1,-1,0,1,2,3,-1,-1,-1,-1,0,1,2,3>(_h_12);
-                _rd3_21 = permute16<-1,-1,-1,-1,0,1,2,3,-1,-1,-1,-1,0,1,2,3>(_h_21);
-                _rd3_11 = permute16<-1,-1,-1,-1,0,1,2,3,-1,-1,-1,-1,0,1,2,3>(_h_11);
-
-                // RD recursion 4, [0 0 0 0 0 0 0 0 C C^2 C^3 C^4 C^5 C^6 C^7 C^8]
-                _rd4_22 = permute16<-1,-1,-1,-1,-1,-1,-1,-1,0,1,2,3,4,5,6,7>(_h_22);
-                _rd4_12 = permute16<-1,-1,-1,-1,-1,-1,-1,-1,0,1,2,3,4,5,6,7>(_h_12);
-                _rd4_21 = permute16<-1,-1,-1,-1,-1,-1,-1,-1,0,1,2,3,4,5,6,7>(_h_21);
-                _rd4_11 = permute16<-1,-1,-1,-1,-1,-1,-1,-1,0,1,2,3,4,5,6,7>(_h_11);
-            };
+            // RD initialization [C 0 ... 0], then recursion s, e.g. L = 8:
+            // [0 C 0 C 0 C 0 C], [0 0 C C^2 0 0 C C^2], [0 0 0 0 C C^2 C^3 C^4]
+            [&]<int... s>(std::integer_sequence<int,s...>){
+
+                ((_rd_22[s] = permute_lanes<rd_factor,s>(_h_22),
+                  _rd_12[s] = permute_lanes<rd_factor,s>(_h_12),
+                  _rd_21[s] = permute_lanes<rd_factor,s>(_h_21),
+                  _rd_11[s] = permute_lanes<rd_factor,s>(_h_11)), ...);
+
+            }(std::make_integer_sequence<int,S+1>{});
+        };
+
+
+
+};
+
+// first order, Y[l] = w[l] + c*Y[l-1] across the lanes with Y[-1] = yi1: a prefix scan in log2(L) steps of
+// one permute and one FMA, instead of the 2x2 blocks above
+template<typename V> class RecurDoublingOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+    constexpr static int S = std::bit_width(unsigned(L))-1; // recursion steps
+
+    private:
+
+        // _rd[0] = [c 0 ... 0], _rd[s] = c^1..c^(2^(s-1)) in the lanes with bit s-1 set
+        std::array<V,S+1> _rd;
+
+    public:
+
+        RecurDoublingOrderOne(){};
+
+        RecurDoublingOrderOne(const T c){
+
+            T p[L];
+
+            p[0] = c;
+            for (auto l=1; l<L; l++) p[l] = c*p[l-1];
+
+            V pv;
+            pv.load(&p[0]);
+
+            [&]<int... s>(std::integer_sequence<int,s...>){
+
+                ((_rd[s] = permute_lanes<rd_factor,s>(pv)), ...);
+
+            }(std::make_integer_sequence<int,S+1>{});
+        };
+
+        __attribute__((always_inline))
+        inline V scan(const V w,const T yi1){
+
+            V y = mul_add(yi1, _rd[0], w);
+
+            [&]<int... s>(std::integer_sequence<int,s...>){
+
+                ((y = mul_add(permute_lanes<rd_broadcast,s+1>(y), _rd[s+1], y)), ...);
+
+            }(std::make_integer_sequence<int,S>{});
+
+            return y;
+        }
+
+};
+
+
+// Order K, the 2x2 blocks above generalized to the K x K companion matrix. With e_l = (y[N-1], ..., y[N-K]) at the
+// end of lane l and w the particular solution, e_l = w_l + C e_{l-1}, C[i][j] the contribution of y[-1-j] to y[N-1-i].
+// Each of the log2(L) steps costs K^2 FMAs, K permutes.
+template<typename V,size_t N,size_t K> class RecurDoublingOrderK{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+    constexpr static int S = std::bit_width(unsigned(L))-1; // recursion steps
+
+    private:
+
+        // contribution of y[-1-j] to y[n]
+        T _h[K][N];
+
+        // _rd[s][i][j]: [C 0 ... 0] for s = 0, C^1..C^(2^(s-1)) in the lanes with bit s-1 set
+        std::array<std::array<std::array<V,K>,K>,S+1> _rd;
+
+        template<typename,size_t,size_t> friend class HomoSolutionOrderK;
+
+    public:
+
+        RecurDoublingOrderK(){};
+
+        // a = {a1, ..., aK}
+        RecurDoublingOrderK(const T (&a)[K]){
+
+            // homogeneous responses over n = -K .. N-1; the one-vector step of IirCoreOrderK has N = 1, there
+            // the rows i >= N of C are the initial values shifted by N
+            T g[K][K+N] = {};
+            T C[K][K], P[K][K], Q[K][K], p[K][K][L];
+
+            for (size_t j=0; j<K; j++){
+
+                g[j][K-1-j] = 1;
+
+                for (size_t n=0; n<N; n++){
+
+                    for (size_t k=1; k<=K; k++) g[j][K+n] += a[k-1]*g[j][K+n-k];
+                    _h[j][n] = g[j][K+n];
+                }
+            }
+
+            for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++) P[i][j] = C[i][j] = g[j][K+N-1-i];
+
+            // C^1 .. C^L
+            for (int l=0; l<L; l++){
+
+                for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++) p[i][j][l] = P[i][j];
+
+                for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++){
+
+                    Q[i][j] = 0;
+                    for (size_t k=0; k<K; k++) Q[i][j] += C[i][k]*P[k][j];
+                }
+
+                for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++) P[i][j] = Q[i][j];
+            }
+
+            for (size_t i=0; i<K; i++) for (size_t j=0; j<K; j++){
+
+                V pv;
+                pv.load(&p[i][j][0]);
+
+                [&]<int... s>(std::integer_sequence<int,s...>){
+
+                    ((_rd[s][i][j] = permute_lanes<rd_factor,s>(pv)), ...);
+
+                }(std::make_integer_sequence<int,S+1>{});
+            }
         };
 
+        template<int s>
+        __attribute__((always_inline))
+        inline void recursion(std::array<V,K>& e){
+
+            std::array<V,K> t;
+
+            #pragma unroll
+            for (size_t j=0; j<K; j++) t[j] = permute_lanes<rd_broadcast,s>(e[j]);
+
+            #pragma unroll
+            for (size_t i=0; i<K; i++)
+                #pragma unroll
+                for (size_t j=0; j<K; j++) e[i] = mul_add(t[j], _rd[s][i][j], e[i]);
+        }
+
+        // e = w at the ends of the lanes on entry, the true ends on return; yi[j] = y[-1-j] before lane 0
+        __attribute__((always_inline))
+        inline void scan(std::array<V,K>& e, const std::array<T,K>& yi){
 
+            #pragma unroll
+            for (size_t i=0; i<K; i++)
+                #pragma unroll
+                for (size_t j=0; j<K; j++) e[i] = mul_add(yi[j], _rd[0][i][j], e[i]);
+
+            [&]<int... s>(std::integer_sequence<int,s...>){
+
+                (recursion<s+1>(e), ...);
+
+            }(std::make_integer_sequence<int,S>{});
+        }
 
 };
 
@@ -288,4 +301,5 @@ template<typename V,size_t N> class RecurDoubling{
 
 
 
+
 #endif
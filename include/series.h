@@ -24,6 +24,34 @@ template<typename... Types> class Series{
                 return _proc<i+1>(r);  
             };
         };
+
+        template<int i, typename U> 
+        __attribute__((always_inline))
+        inline void _apply(U& x) {
+
+            if constexpr (i < std::tuple_size<decltype(_t)>::value) {
+
+                std::get<i>(_t).apply(x);
+                _apply<i+1>(x);  
+            };
+        };
+
+        // section i works on block s-i, which sits in slot (s-i) % K of the ring
+        template<int i, bool guard, typename U, size_t K> 
+        __attribute__((always_inline))
+        inline void _wave(std::array<U,K>& w, const size_t s, const size_t nb) {
+
+            if constexpr (i < std::tuple_size<decltype(_t)>::value) {
+
+                if (!guard || (s >= i && s - i < nb)){
+
+                    std::get<i>(_t).apply(w[(s - i) % K]);
+                }
+
+                _wave<i+1,guard>(w, s, nb);  
+            };
+        };
+
         
     public:
 
@@ -37,6 +65,49 @@ template<typename... Types> class Series{
             return _proc<0>(x); 
         };
 
+        // multi-block blocks in place, every section overwrites the caller's buffer
+        template<typename U> 
+        __attribute__((always_inline))
+        inline void apply(U& x) { 
+            _apply<0>(x); 
+        };
+
+        // software-pipelined step s over a ring of K >= #sections blocks: section i runs on block s-i, so the
+        // sections are independent of each other within a step and their FMA chains can overlap
+        template<typename U, size_t K> 
+        __attribute__((always_inline))
+        inline void wavefront(std::array<U,K>& w, const size_t s) { 
+            static_assert(K >= sizeof...(Types));
+            _wave<0,false>(w, s, 0); 
+        };
+
+        // same, during pipeline fill and drain: only blocks 0 <= s-i < nb are processed
+        template<typename U, size_t K> 
+        __attribute__((always_inline))
+        inline void wavefront(std::array<U,K>& w, const size_t s, const size_t nb) { 
+            static_assert(K >= sizeof...(Types));
+            _wave<0,true>(w, s, nb); 
+        };
+
+        template<typename U> 
+        __attribute__((always_inline))
+        inline void sync() { 
+            std::apply([](auto&... s){ (s.template sync<U>(), ...); }, _t); 
+        };
+
+        // per-section {xi1,xi2,yi1,yi2} of path U, in cascade order
+        template<typename U, typename S> 
+        inline void state(S& s) { 
+            size_t m = 0;
+            std::apply([&](auto&... c){ ((s[m++] = c.template state<U>()), ...); }, _t); 
+        };
+
+        template<typename S> 
+        inline void reset(const S& s) { 
+            size_t m = 0;
+            std::apply([&](auto&... c){ (c.reset(s[m++]), ...); }, _t); 
+        };
+
 };
 
 
@@ -54,17 +125,19 @@ template <class... Types> constexpr Series<unwrap_decay_t<Types>...> make_series
     return Series<unwrap_decay_t<Types>...>(std::forward<Types>(args)...);
 };
 
-template<typename V,size_t N, typename Array1, typename Array2, std::size_t... I>
+template<typename V,size_t N,typename A,bool Odd, typename Array1, typename Array2, std::size_t... I>
 __attribute__((always_inline))
 auto make_series_from_coeffs(const Array1& coefs, const Array2& inits, std::index_sequence<I...>) {
-    using Class = IirCoreOrderTwo<V,N>;
-    return make_series(Class(coefs[I], inits[I])...); 
+    using Class = IirCoreOrderTwo<V,N,A>;
+    if constexpr (Odd) return make_series(Class(coefs[I], inits[I])..., IirCoreOrderOne<V,N,A>(coefs[sizeof...(I)], inits[sizeof...(I)])); 
+    else return make_series(Class(coefs[I], inits[I])...); 
 };
 
-template<typename T, typename V, size_t N, size_t M, typename indices = std::make_index_sequence<M>>
+// Odd: the last row is a first-order section {1,b1,0,a1,0}, e.g. M = 5 rows for order 9
+template<typename T, typename V, size_t N, typename A = algo::CR, bool Odd = false, size_t M, typename indices = std::make_index_sequence<M - Odd>>
 __attribute__((always_inline))
 auto series_from_coeffs(const T (&coefs)[M][5], const T (&inits)[M][4]={0}) { 
-    return make_series_from_coeffs<V,N>(coefs, inits, indices{});
+    return make_series_from_coeffs<V,N,A,Odd>(coefs, inits, indices{});
 };
 
 
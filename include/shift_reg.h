@@ -2,6 +2,7 @@
 #define SHIFT_REG_H 1
 
 #include "../src/vcl/vectorclass.h"
+#include "lanes.h"
 #include <utility> 
 
 template<typename V> class Shift{
@@ -17,17 +18,7 @@ template<typename V> class Shift{
 
         Shift(){};
 
-        inline void shift(const T x){
-
-            // SSE
-            if constexpr (L == 4) _buffer = blend4<1,2,3,4>(_buffer, x); 
-            
-            // AVX2
-            if constexpr (L == 8) _buffer = blend8<1,2,3,4,5,6,7,8>(_buffer, x); 
-            
-            // AVX512
-            if constexpr (L == 16) _buffer = blend16<1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16>(_buffer, x);
-        }; 
+        inline void shift(const T x){ _buffer = blend_lanes<shift_down_in>(_buffer, x);}; 
             
         inline void shift(const V x){ _buffer = x;}; 
          
@@ -38,4 +29,25 @@ template<typename V> class Shift{
         
 };
 
+
+// The L x L matrix whose column l is h shifted up by l lanes, zeros in, as a window over 2L samples: column l is
+// one unaligned load at L - l, 2L samples instead of L vectors.
+template<typename V> class Toeplitz{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size(); 
+
+    private:
+
+        alignas(sizeof(T)*L) T _w[2*L] = {};
+
+    public:
+
+        Toeplitz(){};
+
+        Toeplitz(const V h){ h.store(&_w[L]);};
+
+        inline V operator[](const int l) const { V v; v.load(&_w[L-l]); return v;}; 
+};
+
 #endif 
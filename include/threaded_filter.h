@@ -0,0 +1,196 @@
+#ifndef THREADED_FILTER_H
+#define THREADED_FILTER_H 1
+
+#include "filter.h"
+#include <array>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+
+// Filter for very long signals, split into one segment per thread.
+//
+// 1. every segment is filtered in parallel, the first one with the true state and the others with zero state,
+// 2. the true boundary states are propagated serially: s_end = z_end + Phi^S s_start, where Phi is the
+//    one-sample transition matrix of the cascade state {xi1,xi2,yi1,yi2}[M], raised to the segment length
+//    by repeated squaring (the log-step idea of RecurDoubling applied to the whole cascade),
+// 3. every segment adds its homogeneous (zero-input) response to the true start state, in parallel, until
+//    that response has decayed below float resolution.
+template<typename V,size_t M,size_t N> class ThreadedFilter{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+    constexpr static size_t K = 4*M;
+
+    using Filter_t = Filter<V,M,N>;
+    using State = typename Filter_t::State;
+    using Matrix = std::array<std::array<double,K>,K>;
+
+    private:
+
+        Filter_t _F;
+        unsigned _threads;
+
+        // a segment shorter than this is not worth a thread
+        constexpr static size_t _min_segment = 64*N*L;
+
+        inline static std::array<double,K> flatten(const State& s){
+
+            std::array<double,K> v;
+            for (size_t m=0; m<M; m++)
+                for (size_t i=0; i<4; i++) v[4*m+i] = s[m][i];
+            return v;
+        }
+
+        inline static State unflatten(const std::array<double,K>& v){
+
+            State s;
+            for (size_t m=0; m<M; m++)
+                for (size_t i=0; i<4; i++) s[m][i] = static_cast<T>(v[4*m+i]);
+            return s;
+        }
+
+        inline static Matrix mul(const Matrix& A, const Matrix& B){
+
+            Matrix C{};
+            for (size_t i=0; i<K; i++)
+                for (size_t k=0; k<K; k++)
+                    for (size_t j=0; j<K; j++) C[i][j] += A[i][k]*B[k][j];
+            return C;
+        }
+
+        // state transition of the cascade over S samples of zero input
+        inline Matrix transition(size_t S){
+
+            Matrix P{}, R{};
+            const T zero[1] = {0};
+            T y[1];
+
+            // one-sample transition, column j is the response to the j-th unit state
+            for (size_t j=0; j<K; j++){
+
+                std::array<double,K> e{};
+                e[j] = 1;
+
+                Filter_t F = _F;
+                F.restore(unflatten(e));
+                F.process(std::span<const T>(zero), std::span<T>(y));
+
+                auto c = flatten(F.state());
+                for (size_t i=0; i<K; i++) P[i][j] = c[i];
+            }
+
+            for (size_t i=0; i<K; i++) R[i][i] = 1;
+
+            while (S){
+
+                if (S & 1) R = mul(P, R);
+                P = mul(P, P);
+                S >>= 1;
+            }
+
+            return R;
+        }
+
+        // add the zero-input response of state s to [d_first, d_last)
+        template<typename OutputIt>
+        inline void homogeneous(const State& s, OutputIt d_first, OutputIt d_last){
+
+            constexpr size_t Z = 16*N*L;
+            std::vector<T> zeros(Z, 0), h(Z);
+
+            Filter_t F = _F;
+            F.restore(s);
+
+            auto norm = [](const State& s){
+                T r = 0;
+                for (auto& si : s) for (auto v : si) r = std::max(r, std::abs(v));
+                return r;
+            };
+            const T stop = norm(s)*std::numeric_limits<T>::epsilon();
+
+            while (d_first != d_last){
+
+                size_t len = std::min<size_t>(Z, d_last - d_first);
+                F(zeros.begin(), zeros.begin() + len, h.begin());
+
+                for (size_t n=0; n<len; n++) *(d_first + n) += h[n];
+                d_first += len;
+
+                if (norm(F.state()) <= stop) break;
+            }
+        }
+
+    public:
+
+        ThreadedFilter(){};
+
+        ThreadedFilter(const T (&coefs)[M][5], const T (&inits)[M][4], const unsigned threads = std::thread::hardware_concurrency()):
+        _F(coefs, inits), _threads(std::max(1u, threads)){};
+
+        template<typename InputIt, typename OutputIt>
+        inline OutputIt operator()(InputIt first, InputIt last, OutputIt d_first){
+
+            const size_t len = last - first;
+            const size_t P = std::min<size_t>(_threads, len/_min_segment);
+
+            if (P <= 1) return _F(first, last, d_first);
+
+            // segment lengths are multiples of N*L, the last one takes the rest
+            const size_t S = len/P/(N*L)*(N*L);
+
+            std::vector<Filter_t> F(P, _F);
+            std::vector<std::thread> pool;
+            State zero{};
+
+            for (size_t p=0; p<P; p++){
+
+                auto b = first + p*S, e = (p == P-1) ? last : b + S;
+                auto d = d_first + p*S;
+
+                if (p > 0) F[p].restore(zero);
+                pool.emplace_back([&F, p, b, e, d](){ F[p](b, e, d); });
+            }
+            for (auto& t : pool) t.join();
+            pool.clear();
+
+            // true state at the start of each segment
+            std::vector<State> s(P);
+            s[0] = _F.state();
+            s[1] = F[0].state();
+
+            Matrix Phi = transition(S), Phi_last = transition(len - (P-1)*S);
+
+            for (size_t p=1; p<P; p++){
+
+                auto z = flatten(F[p].state());
+                auto x = flatten(s[p]);
+                auto& A = (p == P-1) ? Phi_last : Phi;
+
+                for (size_t i=0; i<K; i++)
+                    for (size_t j=0; j<K; j++) z[i] += A[i][j]*x[j];
+
+                if (p < P-1) s[p+1] = unflatten(z);
+                else _F.restore(unflatten(z));
+            }
+
+            for (size_t p=1; p<P; p++){
+
+                auto d = d_first + p*S, e = (p == P-1) ? d_first + len : d + S;
+                pool.emplace_back([this, &s, p, d, e](){ homogeneous(s[p], d, e); });
+            }
+            for (auto& t : pool) t.join();
+
+            return d_first + len;
+        };
+
+        inline State state(){ return _F.state();};
+
+        inline void restore(const State& s){ _F.restore(s);};
+
+};
+
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef TUNED_FILTER_H
+#define TUNED_FILTER_H 1
+
+#include "filter.h"
+#include <array>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+
+namespace tuning{
+
+    // block sizes n L with n a power of two or three times one: L, 2L, 3L, 4L, 6L, ... up to 128 vectors,
+    // CR no longer needs N = 2^R and the 3 2^k sizes fill the gaps of the power-of-two grid
+    inline constexpr bool is_block_count(const size_t n){ 
+
+        const size_t m = (n % 3 == 0) ? n/3 : n;
+        return m && (m & (m - 1)) == 0;
+    }
+
+    template<typename V> constexpr size_t num_sizes(){
+
+        size_t k = 0;
+        for (size_t n=V::size(); n<=128; n+=V::size()) k += is_block_count(n/V::size());
+        return k;
+    }
+
+    // the i-th block size of the grid, ascending
+    template<typename V> constexpr size_t block_size(const size_t i){
+
+        size_t k = 0;
+        for (size_t n=V::size(); n<=128; n+=V::size()) if (is_block_count(n/V::size()) && k++ == i) return n;
+        return 0;
+    }
+
+    // one Filter variant TunedFilter may build: block size N and an algo:: tag
+    template<size_t N_,typename A_> struct Config{ constexpr static size_t N = N_; using A = A_;};
+
+    // calls f.template operator()<N,A>() for every (N,A) the autotuner measures
+    template<typename V,typename F>
+    inline void for_each_candidate(F&& f){
+
+        [&]<size_t... I>(std::index_sequence<I...>){
+
+            ([&]<size_t N>(){
+
+                f.template operator()<N,algo::CR>();
+                f.template operator()<N,algo::PH>();
+                f.template operator()<N,algo::Block>();
+
+            }.template operator()<block_size<V>(I)>(), ...);
+
+        }(std::make_index_sequence<num_sizes<V>()>{});
+    }
+
+    template<typename T> constexpr const char* precision(){ return sizeof(T) == 8 ? "double" : "float";};
+}
+
+
+// Fastest (N, algorithm, prefetch distance) per (precision, lanes, sections) on one machine, written by test/autotune.cpp.
+// One entry per line, '#' starts a comment, a later entry for the same key replaces an earlier one:
+//   float 8 4 32 CR 3.71 1024     precision, lanes, sections M, block size N, algo:: name, cycles/sample,
+//                                 prefetch distance in samples (optional, 0 if missing)
+class TuningProfile{
+
+    public:
+
+        struct Entry{
+
+            std::string precision;
+            int lanes;
+            size_t sections;
+            size_t N;
+            std::string algorithm;
+            double cps;
+            size_t prefetch = 0;
+        };
+
+    private:
+
+        std::vector<Entry> _E;
+
+    public:
+
+        TuningProfile(){};
+
+        // false if the file can't be opened, malformed lines are skipped
+        inline bool load(const std::string& path){
+
+            std::ifstream in(path);
+            if (!in.is_open()) return false;
+
+            std::string line;
+            while (std::getline(in, line)){
+
+                line = line.substr(0, line.find('#'));
+
+                Entry e;
+                std::istringstream s(line);
+                if (!(s >> e.precision >> e.lanes >> e.sections >> e.N >> e.algorithm >> e.cps)) continue;
+                if (!(s >> e.prefetch)) e.prefetch = 0;
+
+                add(e);
+            }
+
+            return true;
+        };
+
+        inline bool save(const std::string& path) const {
+
+            std::ofstream out(path);
+            if (!out.is_open()) return false;
+
+            out << "# precision lanes sections N algorithm cycles/sample prefetch\n";
+            for (const auto& e : _E)
+                out << e.precision << " " << e.lanes << " " << e.sections << " " << e.N << " " << e.algorithm << " " << e.cps << " " << e.prefetch << "\n";
+
+            return out.good();
+        };
+
+        inline void add(const Entry& e){
+
+            for (auto& f : _E) if (f.precision == e.precision && f.lanes == e.lanes && f.sections == e.sections){ f = e; return;}
+            _E.push_back(e);
+        };
+
+        inline const Entry* find(const std::string& precision, const int lanes, const size_t sections) const {
+
+            for (const auto& e : _E) if (e.precision == precision && e.lanes == lanes && e.sections == sections) return &e;
+            return nullptr;
+        };
+
+        inline const std::vector<Entry>& entries() const { return _E;};
+
+        // the profile of this machine, read once from $FILTER_TUNING_PROFILE or ./filter_tuning.prof
+        inline static const TuningProfile& system(){
+
+            static const TuningProfile p = []{
+
+                TuningProfile q;
+                const char* path = std::getenv("FILTER_TUNING_PROFILE");
+                q.load(path ? path : "filter_tuning.prof");
+                return q;
+            }();
+
+            return p;
+        };
+};
+
+
+// Filter<V,M,N,A> behind a block-size and algorithm independent interface
+template<typename V,size_t M> class TunedKernel{
+
+    using T = decltype(std::declval<V>().extract(0));
+
+    public:
+
+        using State = std::array<std::array<T,4>,M>;
+
+        virtual ~TunedKernel(){};
+
+        virtual T* operator()(const T* first, const T* last, T* d_first) = 0;
+
+        virtual State state() = 0;
+
+        virtual void restore(const State& s) = 0;
+
+        virtual void prefetch(const size_t distance) = 0;
+
+        virtual size_t block_size() const = 0;
+
+        virtual const char* algorithm() const = 0;
+};
+
+
+template<typename V,size_t M,size_t N,typename A> class TunedKernelNA: public TunedKernel<V,M>{
+
+    using T = decltype(std::declval<V>().extract(0));
+    using State = typename TunedKernel<V,M>::State;
+
+    private:
+
+        Filter<V,M,N,A> _F;
+
+    public:
+
+        TunedKernelNA(const T (&coefs)[M][5], const T (&inits)[M][4]): _F(coefs, inits){};
+
+        T* operator()(const T* first, const T* last, T* d_first) override { return _F(first, last, d_first);};
+
+        State state() override { return _F.state();};
+
+        void restore(const State& s) override { _F.restore(s);};
+
+        void prefetch(const size_t distance) override { _F.prefetch(distance);};
+
+        size_t block_size() const override { return N;};
+
+        const char* algorithm() const override { return A::name;};
+};
+
+
+// Builds the Filter variant a TuningProfile picked for this (precision, lanes, M) at construction, with its prefetch distance.
+// Only the Configs given are compiled in, e.g. the ones test/autotune.cpp reports for the target machines: without an
+// entry, or with one naming a variant not among them, it falls back to N = 32 with CR.
+template<typename V,size_t M,typename... C> class TunedFilter{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+
+    constexpr static size_t DefaultN = 32;
+
+    private:
+
+        std::unique_ptr<TunedKernel<V,M>> _K;
+
+    public:
+
+        using State = typename TunedKernel<V,M>::State;
+
+        TunedFilter(const T (&coefs)[M][5], const T (&inits)[M][4], const TuningProfile& profile = TuningProfile::system()){
+
+            const auto* e = profile.find(tuning::precision<T>(), L, M);
+
+            if (e){
+
+                ([&]{
+
+                    if (!_K && e->N == C::N && e->algorithm == C::A::name) _K = std::make_unique<TunedKernelNA<V,M,C::N,typename C::A>>(coefs, inits);
+                }(), ...);
+            }
+
+            if (!_K) _K = std::make_unique<TunedKernelNA<V,M,DefaultN,algo::CR>>(coefs, inits);
+            if (e) _K->prefetch(e->prefetch);
+        };
+
+        inline T* operator()(const T* first, const T* last, T* d_first){ return (*_K)(first, last, d_first);};
+
+        inline void process(std::span<const T> chunk, std::span<T> out){ (*_K)(chunk.data(), chunk.data() + chunk.size(), out.data());};
+
+        inline void process(std::span<T> chunk){ (*_K)(chunk.data(), chunk.data() + chunk.size(), chunk.data());};
+
+        inline State state(){ return _K->state();};
+
+        inline void restore(const State& s){ _K->restore(s);};
+
+        inline void prefetch(const size_t distance){ _K->prefetch(distance);};
+
+        inline size_t block_size() const { return _K->block_size();};
+
+        inline const char* algorithm() const { return _K->algorithm();};
+};
+
+
+#endif // header guard
@@ -0,0 +1,165 @@
+// One-shot calibration: times every Filter variant of include/tuned_filter.h and writes the fastest
+// (N, algorithm), then the best prefetch distance for it, per filter order into a tuning profile that TunedFilter loads at startup.
+// It also prints the tuning::Config of each choice, TunedFilter compiles in only the configs it is given.
+//
+// run: ./test.sh autotune.cpp   (writes ./filter_tuning.prof, or $FILTER_TUNING_PROFILE)
+// e.g. -DFILTER_VEC=Vec4d to tune double precision, entries of other precisions in the profile are kept.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <pthread.h>
+#include <thread>
+#include <sched.h>
+#include <vector>
+#include <limits>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include "../src/vcl/vectorclass.h"
+#include "../include/tuned_filter.h"
+#include "timing.h"
+
+
+#ifdef FILTER_VEC
+using V = FILTER_VEC;
+#else
+using V = Vec8f;
+#endif
+using T = decltype(std::declval<V>().extract(0));
+constexpr int L = V::size();
+
+constexpr T b1 = 2, b2 = 1, a1 = 1.3, a2 = -0.4;
+constexpr T xi1 = 2, xi2 = 1, yi1 = -3, yi2 = -5;
+
+// large-array workload of run_filter4.cpp, fewer runs since every variant is measured
+constexpr static int vector_size = 131072;
+constexpr int ITERS  = 200;
+constexpr int WARMUP = 20;
+constexpr int REPEATS = 5;
+
+// software prefetch distances in samples tried on the fastest variant, 0 is the hardware prefetcher alone
+constexpr size_t prefetch_distances[] = {0, 256, 1024, 4096, 16384};
+
+
+// the TunedFilter config of a variant, as it is spelled in the source
+template<size_t N,typename A>
+std::string tag(){
+
+    const char* a = std::is_same_v<A,algo::CR> ? "CR" : std::is_same_v<A,algo::PH> ? "PH" : "Block";
+    return "tuning::Config<" + std::to_string(N) + ",algo::" + a + ">";
+}
+
+
+// best of REPEATS TSC measurements, in cycles per sample
+template<typename F>
+double measure(F& _F, const std::vector<T>& in, std::vector<T>& out){
+
+    for (int i = 0; i < WARMUP; ++i) _F(in.data(), in.data() + vector_size, out.data());
+
+    double best = std::numeric_limits<double>::max();
+
+    for (int r = 0; r < REPEATS; ++r){
+
+        uint64_t tsc0 = rdtsc_begin();
+
+        for (int i = 0; i < ITERS; ++i) _F(in.data(), in.data() + vector_size, out.data());
+
+        uint64_t tsc1 = rdtsc_end();
+
+        best = std::min(best, double(tsc1 - tsc0) / ITERS / vector_size);
+    }
+
+    return best;
+}
+
+
+template<size_t M>
+TuningProfile::Entry tune(const std::vector<T>& in, std::vector<T>& out){
+
+    T coefs[M][5], inits[M][4];
+    for (size_t m = 0; m < M; ++m){
+
+        const T c[5] = {1,b1,b2,a1,a2}, s[4] = {xi1,xi2,yi1,yi2};
+        std::copy(c, c + 5, coefs[m]);
+        std::copy(s, s + 4, inits[m]);
+    }
+
+    TuningProfile::Entry best{tuning::precision<T>(), L, M, 0, "", std::numeric_limits<double>::max()};
+    std::string config;
+
+    tuning::for_each_candidate<V>([&]<size_t N,typename A>(){
+
+        auto _F = Filter<V,M,N,A>(coefs, inits);
+        double cps = measure(_F, in, out);
+
+        std::cout << "  M = " << M << ", N = " << N << ", " << A::name << ": " << cps << " cycles/sample\n";
+
+        if (cps < best.cps){ best.N = N; best.algorithm = A::name; best.cps = cps; config = tag<N,A>();}
+    });
+
+    // then the prefetch distance on the fastest variant
+    const double cps0 = best.cps;
+
+    tuning::for_each_candidate<V>([&]<size_t N,typename A>(){
+
+        if (N != best.N || best.algorithm != A::name) return;
+
+        for (size_t d : prefetch_distances){
+
+            auto _F = Filter<V,M,N,A>(coefs, inits);
+            _F.prefetch(d);
+            double cps = measure(_F, in, out);
+
+            std::cout << "  M = " << M << ", prefetch = " << d << ": " << cps << " cycles/sample\n";
+
+            // a distance has to beat the plain variant clearly, otherwise measurement noise decides
+            if (d == 0 || cps < std::min(best.cps, 0.98*cps0)){ best.cps = cps; best.prefetch = d;}
+        }
+    });
+
+    std::cout << "IIR filter order = " << 2*M << ": N = " << best.N << ", " << best.algorithm << ", prefetch = " << best.prefetch << "\n";
+    std::cout << "  compile in with TunedFilter<V," << M << "," << config << ">\n\n";
+
+    return best;
+}
+
+
+int main(){
+
+    //–– Pin to core 0
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(0, &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        std::cerr << "Warning: failed to set CPU affinity\n";
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<T> in(vector_size), out(vector_size);
+    fill_workload(in.begin(), in.end());
+
+    const char* env = std::getenv("FILTER_TUNING_PROFILE");
+    const std::string path = env ? env : "filter_tuning.prof";
+
+    TuningProfile profile;
+    profile.load(path);
+
+    std::cout << "=== AUTOTUNE, lanes = " << L << " x " << tuning::precision<T>() << " ===\n";
+
+    // filter orders 2, 4, 8, 16 as in the measurement tables
+    profile.add(tune<1>(in, out));
+    profile.add(tune<2>(in, out));
+    profile.add(tune<4>(in, out));
+    profile.add(tune<8>(in, out));
+
+    if (!profile.save(path)){
+
+        std::cerr << "Failed to write " << path << "\n";
+        return 1;
+    }
+
+    std::cout << "Tuning profile written to " << path << "\n";
+    return 0;
+}
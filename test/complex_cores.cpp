@@ -0,0 +1,105 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/complex_cores.h"
+#include <vector>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("complex cores:");
+
+
+template<size_t K>
+std::vector<std::complex<double>> reference(const std::vector<std::complex<float>>& x, const std::complex<float> (&b)[K], const std::complex<float> (&a)[K]){
+
+    std::vector<std::complex<double>> y(x.size());
+    std::complex<double> xi[K] = {}, yi[K] = {};
+
+    for (size_t n=0; n<x.size(); n++){
+
+        std::complex<double> out = x[n];
+        for (size_t k=0; k<K; k++) out += std::complex<double>(b[k])*xi[k] + std::complex<double>(a[k])*yi[k];
+
+        for (size_t k=K-1; k>0; k--){ xi[k] = xi[k-1]; yi[k] = yi[k-1];}
+        xi[0] = x[n];
+        yi[0] = out;
+
+        y[n] = out;
+    }
+
+    return y;
+}
+
+std::vector<std::complex<float>> signal(const size_t size){
+
+    std::vector<std::complex<float>> x(size);
+    for (size_t n=0; n<size; n++) x[n] = {std::sin(0.01f*n) + 0.1f*(n % 7), std::cos(0.013f*n) - 0.1f*(n % 5)};
+    return x;
+}
+
+
+TEST_CASE_TEMPLATE("complex first order:", V, Vec8f, Vec16f){
+
+    constexpr static size_t N = V::size();
+    constexpr static size_t Lc = V::size()/2;
+    constexpr static size_t vector_size = 40*N*Lc + 3*Lc + 1;
+    using C = std::complex<float>;
+
+    const C b[1] = {{0.5f,-0.3f}}, a[1] = {{0.6f,0.7f}}; // |a1| < 1
+
+    auto in = signal(vector_size);
+    std::vector<C> out(vector_size);
+
+    auto ref = reference(in, b, a);
+
+    ComplexIirCoreOrderOne<V,N> _F(b, a);
+
+    // in two chunks, the state carries over
+    auto d_last = _F(in.begin(), in.begin() + 1001, out.begin());
+    d_last = _F(in.begin() + 1001, in.end(), d_last);
+
+    CHECK(d_last == out.end());
+
+    for (size_t r=0; r<vector_size; r++){
+
+        CHECK(ref[r].real() == doctest::Approx(out[r].real()).epsilon(1e-4));
+        CHECK(ref[r].imag() == doctest::Approx(out[r].imag()).epsilon(1e-4));
+    }
+}
+
+
+TEST_CASE_TEMPLATE("complex second order:", V, Vec8f, Vec16f){
+
+    constexpr static size_t N = 2*V::size();
+    constexpr static size_t Lc = V::size()/2;
+    constexpr static size_t vector_size = 20*N*Lc + 2*Lc + 3;
+    using C = std::complex<float>;
+
+    // poles 0.8*exp(+-0.3i) and 0.5i, not conjugate
+    const C p1 = std::polar(0.8f, 0.3f), p2 = {0.f, 0.5f};
+    const C b[2] = {{0.2f,0.1f},{-0.3f,0.4f}}, a[2] = {p1 + p2, -p1*p2};
+
+    auto in = signal(vector_size);
+
+    auto ref = reference(in, b, a);
+
+    ComplexIirCoreOrderTwo<V,N> _F(b, a);
+    _F.process(std::span<C>(in));
+
+    for (size_t r=0; r<vector_size; r++){
+
+        CHECK(ref[r].real() == doctest::Approx(in[r].real()).epsilon(1e-4));
+        CHECK(ref[r].imag() == doctest::Approx(in[r].imag()).epsilon(1e-4));
+    }
+
+    // the state is the last two samples of x and y
+    auto s = _F.state();
+    CHECK(std::abs(ref[vector_size-1] - std::complex<double>(s[2])) < 1e-3);
+    CHECK(std::abs(ref[vector_size-2] - std::complex<double>(s[3])) < 1e-3);
+}
+
+
+TEST_SUITE_END();
+
+#endif // doctest
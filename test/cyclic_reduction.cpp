@@ -7,6 +7,8 @@
 #include "../include/shift_reg.h"
 #include <numeric>
 #include <array>
+#include <cmath>
+#include <type_traits>
 
 
 
@@ -138,6 +140,234 @@ TEST_CASE("Cyclic Reduction V16:"){
 }
 
 
+TEST_CASE("Cyclic Reduction V2d:"){
+
+    using V = Vec2d;
+    constexpr int L = V::size();
+    constexpr int N = 4*L;
+    using T = double;
+
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+
+    std::array<T,N*L> data,data_out;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<V,N> in,out,in_T,out_T,tmp_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+
+    FirCoreOrderTwo<V,N> F(b1,b2,xi1,xi2); 
+    CyclicReduction<V,N> CR(a1,a2,yi1,yi2); // test first constructor
+
+    for (int n=0;n<N*L;n++){
+
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
+
+    in_T = permuteV(in);
+    tmp_T = F(in_T);
+    out_T = CR(tmp_T);
+    out = depermuteV(out_T);
+    
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    
+    for (auto r=0; r<N*L; r++) 
+        CHECK(data_out[r] == doctest::Approx(res[r]).epsilon(1e-12));
+    
+}
+
+
+
+TEST_CASE("Cyclic Reduction V4d:"){
+
+    using V = Vec4d;
+    constexpr int L = V::size();
+    constexpr int N = L;
+    using T = double;
+
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+
+    std::array<T,N*L> data,data_out;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<V,N> in,out,in_T,out_T,tmp_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+
+    FirCoreOrderTwo<V,N> F(b1,b2,xi1,xi2); 
+    CyclicReduction<V,N> CR(a1,a2,yi1,yi2); // test first constructor
+
+    for (int n=0;n<N*L;n++){
+
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
+
+    in_T = permuteV(in);
+    tmp_T = F(in_T);
+    out_T = CR(tmp_T);
+    out = depermuteV(out_T);
+    
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    
+    for (auto r=0; r<N*L; r++) 
+        CHECK(data_out[r] == doctest::Approx(res[r]).epsilon(1e-12));
+    
+}
+
+
+
+TEST_CASE("Cyclic Reduction V8d:"){
+
+    using V = Vec8d;
+    constexpr int L = V::size();
+    constexpr int N = L;
+    using T = double;
+
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+
+    std::array<T,N*L> data,data_out;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<V,N> in,out,in_T,out_T,tmp_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+
+    FirCoreOrderTwo<V,N> F(b1,b2,xi1,xi2); 
+    CyclicReduction<V,N> CR(a1,a2,yi1,yi2); // test first constructor
+
+    for (int n=0;n<N*L;n++){
+
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
+
+    in_T = permuteV(in);
+    tmp_T = F(in_T);
+    out_T = CR(tmp_T);
+    out = depermuteV(out_T);
+    
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    
+    for (auto r=0; r<N*L; r++) 
+        CHECK(data_out[r] == doctest::Approx(res[r]).epsilon(1e-12));
+    
+}
+
+
+
+TEST_CASE_TEMPLATE("Cyclic Reduction V8 - odd and composite N:", C, std::integral_constant<size_t,3>, std::integral_constant<size_t,5>, 
+                   std::integral_constant<size_t,6>, std::integral_constant<size_t,12>, std::integral_constant<size_t,24>, std::integral_constant<size_t,40>){
+
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = C::value;
+    using T = float;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+
+    // two frames, the second one starts from the state the first left behind
+    std::array<T,2*N*L> data,data_out;
+    for (auto n=0; n<2*N*L; n++) data[n] = std::sin(0.1f*n) + 0.05f*(n % 11);
+
+    FirCoreOrderTwo<V,N> F(b1,b2,xi1,xi2); 
+    CyclicReduction<V,N> CR(a1,a2,yi1,yi2);
+
+    for (int n=0;n<2*N*L;n++){
+
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
+
+    for (auto f=0; f<2; f++){
+
+        // lane l holds the samples l*N .. l*N+N-1 of the frame, permuteV needs N to be a multiple of L
+        std::array<V,N> in_T,out_T;
+        T tmp[L];
+
+        for (auto n=0; n<N; n++){
+
+            for (auto l=0; l<L; l++) tmp[l] = data[f*N*L + l*N + n];
+            in_T[n].load(tmp);
+        }
+
+        auto v_T = F(in_T);
+        out_T = CR(v_T);
+
+        for (auto n=0; n<N; n++){
+
+            out_T[n].store(tmp);
+            for (auto l=0; l<L; l++) CHECK(data_out[f*N*L + l*N + n] == doctest::Approx(tmp[l]).epsilon(1e-4));
+        }
+    }
+
+    auto s = CR.state();
+    CHECK(s[0] == doctest::Approx(data_out[2*N*L-1]).epsilon(1e-4));
+    CHECK(s[1] == doctest::Approx(data_out[2*N*L-2]).epsilon(1e-4));
+}
+
+
+
+TEST_CASE_TEMPLATE("Cyclic Reduction first order V8:", C, std::integral_constant<size_t,1>, std::integral_constant<size_t,2>, std::integral_constant<size_t,3>, 
+                   std::integral_constant<size_t,8>, std::integral_constant<size_t,12>, std::integral_constant<size_t,40>){
+
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = C::value;
+    using T = float;
+
+    float b1 = 0.7, a1 = 0.9, xi1 = 0.3, yi1 = -1.2;
+
+
+    // two frames, the second one starts from the state the first left behind
+    std::array<T,2*N*L> data,data_out;
+    for (auto n=0; n<2*N*L; n++) data[n] = std::sin(0.1f*n) + 0.05f*(n % 11);
+
+    FirCoreOrderOne<V,N> F(b1,xi1); 
+    CyclicReductionOrderOne<V,N> CR(a1,yi1);
+
+    for (int n=0;n<2*N*L;n++){
+
+        if (n == 0) data_out[0] = data[0] + b1*xi1 + a1*yi1;
+        else data_out[n] = data[n] + b1*data[n-1] + a1*data_out[n-1];
+    }
+
+    for (auto f=0; f<2; f++){
+
+        std::array<V,N> x_T;
+        T tmp[L];
+
+        for (auto n=0; n<N; n++){
+
+            for (auto l=0; l<L; l++) tmp[l] = data[f*N*L + l*N + n];
+            x_T[n].load(tmp);
+        }
+
+        F.apply(x_T);
+        CR.apply(x_T);
+
+        for (auto n=0; n<N; n++){
+
+            x_T[n].store(tmp);
+            for (auto l=0; l<L; l++) CHECK(data_out[f*N*L + l*N + n] == doctest::Approx(tmp[l]).epsilon(1e-4));
+        }
+    }
+
+    CHECK(CR.state() == doctest::Approx(data_out[2*N*L-1]).epsilon(1e-4));
+    CHECK(F.state() == data[2*N*L-1]);
+}
+
+
+
 TEST_SUITE_END();
 
 #endif
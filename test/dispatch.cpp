@@ -0,0 +1,101 @@
+// build and run with ../dispatch/build.sh dispatch.cpp, the instruction-set objects are linked in
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/dispatch.h"
+#include <numeric>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("dispatch:");
+
+
+template<size_t M>
+std::vector<float> reference(const std::vector<float>& x, const float (&coefs)[M][5], const float (&inits)[M][4]){
+
+    std::vector<float> y = x;
+
+    for (size_t m=0; m<M; m++){
+
+        float xi1 = inits[m][0], xi2 = inits[m][1], yi1 = inits[m][2], yi2 = inits[m][3];
+
+        for (auto& v : y){
+
+            float out = v + coefs[m][1]*xi1 + coefs[m][2]*xi2 + coefs[m][3]*yi1 + coefs[m][4]*yi2;
+            xi2 = xi1; xi1 = v;
+            yi2 = yi1; yi1 = out;
+            v = out;
+        }
+    }
+
+    return y;
+}
+
+
+TEST_CASE("every instruction set matches the scalar reference:"){
+
+    constexpr size_t M = 2, N = 16;
+    constexpr size_t vector_size = 16*N*16 + 37;
+
+    float coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2}};
+    float inits[M][4] = {{2,1,-3,-5},{0.5,0,1,-1}};
+
+    std::vector<float> in(vector_size), out(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = std::sin(0.01f*n) + 0.1f*(n % 7);
+
+    auto ref = reference(in, coefs, inits);
+
+    const std::pair<int,const char*> levels[] = {{2,"sse"},{8,"avx2"},{10,"avx512"}};
+
+    for (auto [level, name] : levels){
+
+        auto F = DispatchFilter<M,N>(coefs, inits, level);
+        CHECK(std::strcmp(F.isa(), name) == 0);
+
+        F.process(std::span<const float>(in), std::span<float>(out));
+
+        for (size_t n=0; n<vector_size; n++) CHECK(out[n] == doctest::Approx(ref[n]).epsilon(1e-4));
+    }
+}
+
+
+TEST_CASE("detected instruction set streams with state:"){
+
+    constexpr size_t M = 4, N = 32;
+    constexpr size_t vector_size = 8192;
+
+    float coefs[M][5], inits[M][4] = {0};
+    for (size_t m=0; m<M; m++){
+
+        float c[5] = {1, 0.5f, 0.25f, 0.2f*(m+1)/M, -0.3f};
+        std::copy(c, c+5, coefs[m]);
+    }
+
+    std::vector<float> in(vector_size), out(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = std::cos(0.003f*n);
+
+    auto ref = reference(in, coefs, inits);
+
+    auto F = DispatchFilter<M,N>(coefs, inits);
+    auto s = F.state();
+
+    // two uneven chunks, then the whole signal again from the saved state
+    F.process(std::span<const float>(in.data(), 3001), std::span<float>(out.data(), 3001));
+    F.process(std::span<const float>(in.data() + 3001, vector_size - 3001), std::span<float>(out.data() + 3001, vector_size - 3001));
+
+    for (size_t n=0; n<vector_size; n++) CHECK(out[n] == doctest::Approx(ref[n]).epsilon(1e-4));
+
+    F.restore(s);
+    F.process(std::span<float>(in));
+
+    for (size_t n=0; n<vector_size; n++) CHECK(in[n] == doctest::Approx(ref[n]).epsilon(1e-4));
+}
+
+
+TEST_SUITE_END();
+
+#endif
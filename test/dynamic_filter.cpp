@@ -0,0 +1,167 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/dynamic_filter.h"
+#include "../include/filter.h"
+#include <numeric>
+#include <vector>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("dynamic filter:");
+
+
+template<typename T>
+std::vector<T> reference(const std::vector<T>& x, const std::vector<std::array<T,5>>& coefs, const std::vector<std::array<T,4>>& inits){
+
+    std::vector<T> y = x;
+
+    for (size_t m=0; m<coefs.size(); m++){
+
+        T xi1 = inits[m][0], xi2 = inits[m][1], yi1 = inits[m][2], yi2 = inits[m][3];
+
+        for (auto& v : y){
+
+            T out = v + coefs[m][1]*xi1 + coefs[m][2]*xi2 + coefs[m][3]*yi1 + coefs[m][4]*yi2;
+            xi2 = xi1; xi1 = v;
+            yi2 = yi1; yi1 = out;
+            v = out;
+        }
+    }
+
+    return y;
+}
+
+template<typename T>
+void design(const size_t M, std::vector<std::array<T,5>>& coefs, std::vector<std::array<T,4>>& inits){
+
+    coefs.resize(M);
+    inits.resize(M);
+
+    for (size_t m=0; m<M; m++){
+
+        coefs[m] = {1, T(-0.5), T(0.25), T(0.3 + 0.4*m/M), T(-0.4)};
+        inits[m] = {T(1), T(-1), T(0.5), T(0)};
+    }
+}
+
+
+TEST_CASE("runtime section counts V8:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 4*L;
+    constexpr static size_t vector_size = 4*N*L + 3*L + 5;
+    using T = float;
+
+    std::vector<T> in(vector_size), out(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = std::sin(T(0.02)*n);
+
+    for (size_t M : {1, 3, 7, 12}){
+
+        std::vector<std::array<T,5>> coefs;
+        std::vector<std::array<T,4>> inits;
+        design(M, coefs, inits);
+
+        auto ref = reference(in, coefs, inits);
+
+        auto _F = DynamicFilter<V,N>(coefs, inits);
+        CHECK(_F.sections() == M);
+
+        _F(in.begin(), in.end(), out.begin());
+
+        for (size_t r=0; r<vector_size; r++) CHECK(ref[r] == doctest::Approx(out[r]).epsilon(1e-4)); // float rounding accumulates across sections
+    }
+}
+
+
+TEST_CASE("same result as the compile-time cascade V16:"){
+
+    using V = Vec16f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static size_t vector_size = 8192 + 21;
+    using T = float;
+    constexpr static size_t M = 4;
+
+    std::vector<std::array<T,5>> coefs;
+    std::vector<std::array<T,4>> inits;
+    design(M, coefs, inits);
+
+    T c[M][5], s[M][4];
+    for (size_t m=0; m<M; m++){
+
+        std::copy(coefs[m].begin(), coefs[m].end(), c[m]);
+        std::copy(inits[m].begin(), inits[m].end(), s[m]);
+    }
+
+    std::vector<T> in(vector_size), out(vector_size), ref(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = T(n % 13) - 6;
+
+    auto _D = DynamicFilter<V,N>(coefs, inits);
+    auto _F = Filter<V,M,N>(c, s);
+
+    _D(in.begin(), in.end(), out.begin());
+    _F(in.begin(), in.end(), ref.begin());
+
+    for (size_t r=0; r<vector_size; r++) CHECK(ref[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("streaming and checkpoint V4d:"){
+
+    using V = Vec4d;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static size_t vector_size = 4099;
+    using T = double;
+    constexpr static size_t M = 5;
+
+    std::vector<std::array<T,5>> coefs;
+    std::vector<std::array<T,4>> inits;
+    design(M, coefs, inits);
+
+    std::vector<T> in(vector_size), out(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = std::cos(0.01*n);
+
+    auto ref = reference(in, coefs, inits);
+
+    auto _F = DynamicFilter<V,N>(coefs, inits);
+
+    std::span<const T> x(in);
+    std::span<T> y(out);
+
+    _F.process(x.subspan(0, 1000), y.subspan(0, 1000));
+
+    auto s = _F.state();
+    _F = DynamicFilter<V,N>(coefs);
+    _F.restore(s);
+
+    _F.process(x.subspan(1000), y.subspan(1000));
+
+    for (size_t r=0; r<vector_size; r++) CHECK(ref[r] == doctest::Approx(out[r]).epsilon(1e-12));
+}
+
+
+TEST_CASE("inits of the wrong length are rejected:"){
+
+    using V = Vec8f;
+    using T = float;
+    constexpr static size_t N = 16;
+
+    std::vector<std::array<T,5>> c(3, {1,1,2,0.4,-0.5});
+    std::vector<std::array<T,4>> s(2, {0,0,0,0});
+
+    CHECK_THROWS_AS((DynamicFilter<V,N>(c, s)), std::invalid_argument);
+
+    s.resize(3);
+    CHECK_NOTHROW((DynamicFilter<V,N>(c, s)));
+    CHECK_NOTHROW((DynamicFilter<V,N>(c)));
+}
+
+
+
+TEST_SUITE_END();
+
+#endif
@@ -3,6 +3,9 @@
 #include "../src/doctest.h"
 #include "../include/filter.h"
 #include <numeric>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 
 #ifdef DOCTEST_LIBRARY_INCLUDED
 
@@ -95,301 +98,958 @@ TEST_CASE("second order block filtering V4:"){
 
 
 
-// TEST_CASE("4th order block filtering:"){
+TEST_CASE("4th order block filtering:"){
 
-//     using V = Vec8f;
-//     constexpr static int L = V::size();
-//     constexpr static int N = L;
-//     constexpr static int vector_size = 16384;
-//     using T = float;
-//     constexpr static int M = 2;
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 16384;
+    using T = float;
+    constexpr static int M = 2;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                        xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    _F(in.begin(),in.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("second order multi-block filter V4:"){
+
+    using V = Vec4f;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 16384;
+    using T = float;
+    constexpr static int M = 1;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    _F(in.begin(),in.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("second order iir filter V8:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 16384;
+    using T = float;
+    constexpr static int M = 1;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    _F(in.begin(),in.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("second order iir filter V16:"){
+
+    using V = Vec16f;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 16384;
+    using T = float;
+    constexpr static int M = 1;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    _F(in.begin(),in.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("4th order iir filter:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 16384;
+    using T = float;
+    constexpr static int M = 2;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                        xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    _F(in.begin(),in.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+TEST_CASE("8th order iir filter:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 4*L;
+    constexpr static int vector_size = 16384;
+    using T = float;
+    constexpr static int M = 4;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    _F(in.begin(),in.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4)); // float rounding accumulates across sections
+}
+
+TEST_CASE("16th order iir filter:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 4*L;
+    constexpr static int vector_size = 16384;
+    using T = float;
+    constexpr static int M = 8;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);  
+
+    in = data;
+
+    _F(in.begin(),in.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4)); // float rounding accumulates across sections
+}
+
+
+TEST_CASE("second order iir filter - remainder:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 16384 + 3*L + 5; // N*L does not divide the signal
+    using T = float;
+    constexpr static int M = 1;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data,in,out;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    auto d_last = _F(in.begin(),in.end(),out.begin());  
+
+    CHECK(d_last == out.end());
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("second order iir filter - N = 3L:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 3*L; // 192 samples per step, 250 steps per second at 48 kHz
+    constexpr static int vector_size = 4800 + 2*L + 3;
+    using T = float;
+    constexpr static int M = 1;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data,in,out;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    auto d_last = _F(in.begin(),in.end(),out.begin());  
+
+    CHECK(d_last == out.end());
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("8th order iir filter - remainder:"){
+
+    using V = Vec16f;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 16384 + L + 7; // N*L does not divide the signal
+    using T = float;
+    constexpr static int M = 4;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+
+    in = data;
+
+    auto d_last = _F(in.begin(),in.end(),out.begin());  
+
+    CHECK(d_last == out.end());
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4)); // float rounding accumulates across sections
+}
+
+
+TEST_CASE("8th order iir filter - streaming and checkpoint:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 32768;
+    using T = float;
+    constexpr static int M = 4;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},out;
+    data[0] = 1; // pass an impulse response 
+    data[10000] = -2; // and re-excite it in the middle of the stream
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+    
+    std::span<const T> in(data);
+    std::span<T> res(out);
+
+    // irregular chunks between 17 and 4096 samples, half way the stream moves to a new filter object
+    size_t pos = 0, chunk = 17, n_chunk = 0;
+    while (pos < vector_size){
+
+        size_t len = std::min(chunk, vector_size - pos);
+        _F.process(in.subspan(pos,len), res.subspan(pos,len));
+        pos += len;
+        chunk = 17 + (chunk*131 + 7) % 4080;
+
+        if (++n_chunk == 8){
+
+            auto s = _F.state();
+            _F = Filter<V,M,N>(coefs, inits);
+            _F.restore(s);
+        }
+    }
+
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4)); // float rounding accumulates across sections
+}
+
+
+TEST_CASE("8th order iir filter - in place:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 8192 + 3*L + 5;
+    using T = float;
+    constexpr static int M = 4;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0};
+    data[0] = 1; // pass an impulse response 
+    data[5000] = -2;
+
+    std::array<T,vector_size> tmp,data_out = data;
+    
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
+
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    // aligned, and shifted by 1 and 3 samples so that a scalar head runs first
+    alignas(64) static T buf[vector_size + L];
+
+    for (int offset : {0, 1, 3}){
+
+        auto _F = Filter<V,M,N>(coefs, inits);
+
+        std::span<T> x(buf + offset, vector_size);
+        std::copy(data.begin(), data.end(), x.begin());
+
+        _F.filter_inplace(x.first(3000));
+        _F.filter_inplace(x.subspan(3000));
+
+        for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(x[r]).epsilon(1e-4)); // float rounding accumulates across sections
+    }
+
+    // whole vectors
+    std::vector<V> xv(vector_size/L);
+    for (size_t n=0; n<xv.size(); n++) xv[n].load(&data[n*L]);
+
+    auto _F = Filter<V,M,N>(coefs, inits);
+    _F.filter_inplace(std::span<V>(xv));
+
+    for (size_t n=0; n<xv.size(); n++)
+        for (int l=0; l<L; l++) CHECK(data_out[n*L + l] == doctest::Approx(xv[n][l]).epsilon(1e-4));
+}
+
+
+TEST_CASE("8th order iir filter - streaming stores:"){
+
+    using V = Vec16f;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 8192 + 3*L + 5;
+    using T = float;
+    constexpr static int M = 4;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-//     std::array<T,vector_size> data{0},in,out;
-//     data[0] = 1; // pass an impulse response 
+    std::array<T,vector_size> data{0};
+    data[0] = 1; // pass an impulse response 
+    data[5000] = -2;
 
-//     std::array<T,vector_size> tmp,data_out = data;
+    std::array<T,vector_size> tmp,data_out = data;
     
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
-//     T coefs[M][5] = {1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2}; 
-//     T inits[M][4] = {xi1,xi2,yi1,yi2,
-//                         xi1,xi2,yi1,yi2};
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
 
-//     auto _F = Filter<V,M,N>(coefs, inits);
+    alignas(64) static T out[vector_size + L];
 
-//     in = data;
+    // output aligned or not, input with the same or a different misalignment
+    for (int offset : {0, 2, 5}){
 
-//     _F(in.begin(),in.end(),out.begin());  
-    
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
-// }
+        auto _F = Filter<V,M,N>(coefs, inits);
 
+        T* d_first = out + offset;
+        T* d_last = _F.streamed(data.data(), data.data() + 4000, d_first);
+        d_last = _F.streamed(data.data() + 4000, data.data() + vector_size, d_last);
 
-// TEST_CASE("second order multi-block filter V4:"){
+        CHECK(d_last == d_first + vector_size);
 
-//     using V = Vec4f;
-//     constexpr static int L = V::size();
-//     constexpr static int N = L;
-//     constexpr static int vector_size = 16384;
-//     using T = float;
-//     constexpr static int M = 1;
+        for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(d_first[r]).epsilon(1e-4)); // float rounding accumulates across sections
+    }
+}
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-//     std::array<T,vector_size> data{0},in,out;
-//     data[0] = 1; // pass an impulse response 
+TEST_CASE("16th order iir filter - pipelined:"){
 
-//     std::array<T,vector_size> tmp,data_out = data;
-    
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 4*L;
+    constexpr static int vector_size = 32768 + 5*L + 3; // blocks and the tail
+    using T = float;
+    constexpr static int M = 8;
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-//     T coefs[M][5] = {1,b1,b2,a1,a2}; 
-//     T inits[M][4] = {xi1,xi2,yi1,yi2};
+    std::array<T,vector_size> data{0},out,out_pipe;
+    data[0] = 1; // pass an impulse response 
+    data[20000] = 3;
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    auto _F = Filter<V,M,N>(coefs, inits);  
+    auto _G = Filter<V,M,N>(coefs, inits);  
+
+    _F(data.begin(),data.end(),out.begin());  
+
+    // same arithmetic per block, only the order in which blocks meet the sections changes
+    auto d_last = _G.pipelined(data.begin(),data.end(),out_pipe.begin());  
+
+    CHECK(d_last == out_pipe.end());
+    for (auto r=0; r<vector_size; r++) CHECK(out[r] == out_pipe[r]);
+
+    // fewer blocks than sections, the pipeline never reaches steady state
+    auto _H = Filter<V,M,N>(coefs, inits);  
+    auto _K = Filter<V,M,N>(coefs, inits);  
+    _H(data.begin(),data.begin() + 3*N*L + 11,out.begin());  
+    _K.pipelined(data.begin(),data.begin() + 3*N*L + 11,out_pipe.begin());  
+    for (auto r=0; r<3*N*L + 11; r++) CHECK(out[r] == out_pipe[r]);
+}
 
-//     auto _F = Filter<V,M,N>(coefs, inits);
 
-//     in = data;
+TEST_CASE("second order iir filter V2d - remainder:"){
 
-//     _F(in.begin(),in.end(),out.begin());  
+    using V = Vec2d;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 16384 + 3*L + 5; // N*L does not divide the signal
+    using T = double;
+    constexpr static int M = 1;
+
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data,in,out;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<T,vector_size> tmp,data_out = data;
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
-// }
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
-// TEST_CASE("second order iir filter V8:"){
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
 
-//     using V = Vec8f;
-//     constexpr static int L = V::size();
-//     constexpr static int N = L;
-//     constexpr static int vector_size = 16384;
-//     using T = float;
-//     constexpr static int M = 1;
+    auto _F = Filter<V,M,N>(coefs, inits);
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    in = data;
 
-//     std::array<T,vector_size> data{0},in,out;
-//     data[0] = 1; // pass an impulse response 
+    auto d_last = _F(in.begin(),in.end(),out.begin());  
 
-//     std::array<T,vector_size> tmp,data_out = data;
+    CHECK(d_last == out.end());
     
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-12));
+}
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
 
-//     T coefs[M][5] = {1,b1,b2,a1,a2}; 
-//     T inits[M][4] = {xi1,xi2,yi1,yi2};
 
-//     auto _F = Filter<V,M,N>(coefs, inits);
+TEST_CASE("8th order iir filter V4d - remainder:"){
 
-//     in = data;
+    using V = Vec4d;
+    constexpr static int L = V::size();
+    constexpr static int N = L;
+    constexpr static int vector_size = 16384 + L + 7; // N*L does not divide the signal
+    using T = double;
+    constexpr static int M = 4;
 
-//     _F(in.begin(),in.end(),out.begin());  
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
-// }
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
-// TEST_CASE("second order iir filter V16:"){
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
 
-//     using V = Vec16f;
-//     constexpr static int L = V::size();
-//     constexpr static int N = L;
-//     constexpr static int vector_size = 16384;
-//     using T = float;
-//     constexpr static int M = 1;
+    auto _F = Filter<V,M,N>(coefs, inits);
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    in = data;
 
-//     std::array<T,vector_size> data{0},in,out;
-//     data[0] = 1; // pass an impulse response 
+    auto d_last = _F(in.begin(),in.end(),out.begin());  
 
-//     std::array<T,vector_size> tmp,data_out = data;
+    CHECK(d_last == out.end());
     
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-12)); 
+}
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
 
-//     T coefs[M][5] = {1,b1,b2,a1,a2}; 
-//     T inits[M][4] = {xi1,xi2,yi1,yi2};
 
-//     auto _F = Filter<V,M,N>(coefs, inits);
+TEST_CASE("8th order iir filter V8d - remainder:"){
 
-//     in = data;
+    using V = Vec8d;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 16384 + L + 7; // N*L does not divide the signal
+    using T = double;
+    constexpr static int M = 4;
 
-//     _F(in.begin(),in.end(),out.begin());  
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
-// }
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
-// TEST_CASE("4th order iir filter:"){
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
 
-//     using V = Vec8f;
-//     constexpr static int L = V::size();
-//     constexpr static int N = L;
-//     constexpr static int vector_size = 16384;
-//     using T = float;
-//     constexpr static int M = 2;
+    auto _F = Filter<V,M,N>(coefs, inits);
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    in = data;
 
-//     std::array<T,vector_size> data{0},in,out;
-//     data[0] = 1; // pass an impulse response 
+    auto d_last = _F(in.begin(),in.end(),out.begin());  
 
-//     std::array<T,vector_size> tmp,data_out = data;
+    CHECK(d_last == out.end());
     
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-12)); 
+}
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
 
-//     T coefs[M][5] = {1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2}; 
-//     T inits[M][4] = {xi1,xi2,yi1,yi2,
-//                         xi1,xi2,yi1,yi2};
 
-//     auto _F = Filter<V,M,N>(coefs, inits);
+TEST_CASE("8th order iir filter - reversed:"){
 
-//     in = data;
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 16384 + 3*L + 5; // remainders sit at the front of the range
+    using T = float;
+    constexpr static int M = 4;
 
-//     _F(in.begin(),in.end(),out.begin());  
-    
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
-// }
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-// TEST_CASE("8th order iir filter:"){
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
 
-//     using V = Vec8f;
-//     constexpr static int L = V::size();
-//     constexpr static int N = 4*L;
-//     constexpr static int vector_size = 16384;
-//     using T = float;
-//     constexpr static int M = 4;
+    std::vector<T> in(vector_size), in_r, out(vector_size), out_r(vector_size);
+    for (int n=0; n<vector_size; n++) in[n] = std::sin(T(0.01)*n);
+    in_r.assign(in.rbegin(), in.rend());
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    // forward over the reversed signal is the reference
+    auto _F = Filter<V,M,N>(coefs, inits);
+    _F(in_r.begin(), in_r.end(), out_r.begin());
+    std::reverse(out_r.begin(), out_r.end());
 
-//     std::array<T,vector_size> data{0},in,out;
-//     data[0] = 1; // pass an impulse response 
+    auto _G = Filter<V,M,N>(coefs, inits);
+    auto d_first = _G.reversed(in.begin(), in.end(), out.end());
 
-//     std::array<T,vector_size> tmp,data_out = data;
+    CHECK(d_first == out.begin());
+
+    for (auto r=0; r<vector_size; r++) CHECK(out_r[r] == doctest::Approx(out[r]).epsilon(1e-4));
+
+    // in place, in two calls: the state carries over from the later part to the earlier one
+    auto _H = Filter<V,M,N>(coefs, inits);
+    _H.reversed(in.begin() + 5000, in.end(), in.end());
+    _H.reversed(in.begin(), in.begin() + 5000, in.begin() + 5000);
+
+    for (auto r=0; r<vector_size; r++) CHECK(out_r[r] == doctest::Approx(in[r]).epsilon(1e-4));
+}
+
+
+
+TEST_CASE_TEMPLATE("8th order iir filter - every algorithm:", A, algo::CR, algo::PH, algo::Block, algo::CR_T, algo::PH_T){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 16384 + L + 7; // N*L does not divide the signal
+    using T = float;
+    constexpr static int M = 4;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
+
+    std::array<T,vector_size> tmp,data_out = data;
     
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
 
-//     T coefs[M][5] = {1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2}; 
-//     T inits[M][4] = {xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2};
+    auto _F = Filter<V,M,N,A>(coefs, inits);
 
-//     auto _F = Filter<V,M,N>(coefs, inits);
+    in = data;
 
-//     in = data;
+    auto d_last = _F(in.begin(),in.begin() + 5000,out.begin());  
+    d_last = _F.pipelined(in.begin() + 5000,in.end(),d_last);  
 
-//     _F(in.begin(),in.end(),out.begin());  
+    CHECK(d_last == out.end());
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
-// }
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4)); // float rounding accumulates across sections
+}
 
-// TEST_CASE("16th order iir filter:"){
 
-//     using V = Vec8f;
-//     constexpr static int L = V::size();
-//     constexpr static int N = 4*L;
-//     constexpr static int vector_size = 16384;
-//     using T = float;
-//     constexpr static int M = 8;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+TEST_CASE_TEMPLATE("9th order iir filter - first-order section:", A, algo::CR, algo::PH, algo::Block){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = 16384 + 3*L + 5;
+    using T = float;
+    constexpr static int M = 5; // four biquads and one first-order section
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float c1 = 0.7, d1 = 0.9;
 
-//     std::array<T,vector_size> data{0},in,out;
-//     data[0] = 1; // pass an impulse response 
+    std::array<T,vector_size> data{0},in,out;
+    data[0] = 1; // pass an impulse response 
 
-//     std::array<T,vector_size> tmp,data_out = data;
+    std::array<T,vector_size> tmp,data_out = data;
     
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (int round=0;round<M-1;round++){
+        for (int n=0;n<vector_size;n++){
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
+    for (int n=0;n<vector_size;n++){
 
-//     T coefs[M][5] = {1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2,
-//                      1,b1,b2,a1,a2}; 
-//     T inits[M][4] = {xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2,
-//                      xi1,xi2,yi1,yi2};
-
-//     auto _F = Filter<V,M,N>(coefs, inits);  
+        if (n == 0) tmp[0] = data_out[0] + c1*xi1 + d1*yi1;
+        else tmp[n] = data_out[n] + c1*data_out[n-1] + d1*tmp[n-1];
+    }
+    data_out = tmp;
 
-//     in = data;
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,c1,0,d1,0}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,0,yi1,0};
 
-//     _F(in.begin(),in.end(),out.begin());  
+    auto _F = Filter<V,M,N,A,true>(coefs, inits);
+
+    in = data;
+
+    auto d_last = _F(in.begin(),in.begin() + 5000,out.begin());  
+    d_last = _F(in.begin() + 5000,in.end(),d_last);  
+
+    CHECK(d_last == out.end());
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
-// }
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4));
+
+    auto s = _F.state();
+    CHECK(s[M-1][1] == 0);
+    CHECK(s[M-1][2] == doctest::Approx(data_out[vector_size-1]).epsilon(1e-4));
+}
+
 
 
 TEST_SUITE_END();
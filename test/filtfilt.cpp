@@ -0,0 +1,115 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/filtfilt.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("filtfilt:");
+
+
+// one pass of the cascade from the steady state of x[0]
+template<size_t M>
+void sosfilt(std::vector<double>& x, const double (&coefs)[M][5]){
+
+    double u = x[0];
+
+    for (size_t m=0; m<M; m++){
+
+        const double g = (1 + coefs[m][1] + coefs[m][2])/(1 - coefs[m][3] - coefs[m][4]);
+        double xi1 = u, xi2 = u, yi1 = g*u, yi2 = g*u;
+        u *= g;
+
+        for (auto& v : x){
+
+            double out = v + coefs[m][1]*xi1 + coefs[m][2]*xi2 + coefs[m][3]*yi1 + coefs[m][4]*yi2;
+            xi2 = xi1; xi1 = v;
+            yi2 = yi1; yi1 = out;
+            v = out;
+        }
+    }
+}
+
+// scipy.signal.sosfiltfilt with padtype = "odd": extend, filter, reverse, filter, reverse, trim
+template<size_t M>
+std::vector<double> reference(const std::vector<double>& x, const double (&coefs)[M][5], const size_t P){
+
+    const size_t n = x.size(), p = std::min(P, n - 1);
+
+    std::vector<double> e;
+    for (size_t k=0; k<p; k++) e.push_back(2*x[0] - x[p-k]);
+    e.insert(e.end(), x.begin(), x.end());
+    for (size_t k=0; k<p; k++) e.push_back(2*x[n-1] - x[n-2-k]);
+
+    sosfilt(e, coefs);
+    std::reverse(e.begin(), e.end());
+    sosfilt(e, coefs);
+    std::reverse(e.begin(), e.end());
+
+    return std::vector<double>(e.begin() + p, e.end() - p);
+}
+
+
+TEST_CASE_TEMPLATE("8th order filtfilt - every algorithm:", A, algo::CR, algo::PH, algo::Block){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static size_t N = 2*L;
+    constexpr static size_t M = 4;
+    using T = float;
+
+    double c[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2},{1,0.2,0.1,-0.6,-0.3},{1,2,1,0.9,-0.4}};
+    T coefs[M][5];
+    for (size_t m=0; m<M; m++) for (size_t i=0; i<5; i++) coefs[m][i] = c[m][i];
+
+    auto _F = FiltFilt<V,M,N,A>(coefs);
+
+    // block multiples, vector and scalar remainders, and signals shorter than the extension
+    for (size_t size : {size_t(N*L*40), size_t(N*L*40 + 3*L + 5), size_t(100), size_t(2*L + 1), size_t(7), size_t(1)}){
+
+        std::vector<double> x(size);
+        for (size_t n=0; n<size; n++) x[n] = std::sin(0.01*n) + 0.1*(n % 7);
+
+        auto ref = reference(x, c, FiltFilt<V,M,N,A>::P);
+
+        std::vector<T> in(x.begin(), x.end()), out(size);
+
+        auto d_last = _F(in.begin(), in.end(), out.begin());
+        CHECK(d_last == out.end());
+
+        for (size_t r=0; r<size; r++) CHECK(ref[r] == doctest::Approx(out[r]).epsilon(1e-4));
+
+        // in place
+        _F.filter_inplace(std::span<T>(in));
+
+        for (size_t r=0; r<size; r++) CHECK(in[r] == out[r]);
+    }
+}
+
+
+TEST_CASE("filtfilt of a constant is the squared DC gain V4d:"){
+
+    using V = Vec4d;
+    constexpr static size_t N = 16;
+    constexpr static size_t M = 2;
+    using T = double;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2}};
+
+    const T G = (4/1.1)*(0.75/0.9);
+
+    std::vector<T> x(5000, T(-1.5)), y(5000);
+
+    FiltFilt<V,M,N>(coefs)(x.begin(), x.end(), y.begin());
+
+    // the steady-state start leaves no transient at either edge
+    for (auto v : y) CHECK(v == doctest::Approx(-1.5*G*G).epsilon(1e-12));
+}
+
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,274 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/fixed_cores.h"
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("fixed cores:");
+
+
+// the biquad in double from rest, on the integer samples
+template<typename T>
+std::vector<double> reference(const std::vector<T>& x, const double b1, const double b2, const double a1, const double a2){
+
+    std::vector<double> y(x.size());
+    double xi1 = 0, xi2 = 0, yi1 = 0, yi2 = 0;
+
+    for (size_t n=0; n<x.size(); n++){
+
+        y[n] = x[n] + b1*xi1 + b2*xi2 + a1*yi1 + a2*yi2;
+        xi2 = xi1; xi1 = x[n];
+        yi2 = yi1; yi1 = y[n];
+    }
+
+    return y;
+}
+
+// amplitude a of full scale
+template<typename T>
+std::vector<T> signal(const size_t size, const double a){
+
+    const double fs = std::ldexp(1.0, 8*sizeof(T) - 1);
+
+    std::vector<T> x(size);
+    for (size_t n=0; n<size; n++) x[n] = static_cast<T>(std::lround(a*fs*(std::sin(0.01*n) + 0.5*std::sin(0.37*n))));
+    return x;
+}
+
+
+TEST_CASE("fixed fir order two Q15:"){
+
+    using V = Vec16s;
+    constexpr static int L = V::size();
+    constexpr static size_t N = L;
+    constexpr static size_t K = 4;
+    using T = int16_t;
+
+    // exact in Q14, so the only error is the rounding of the output
+    const double b1 = 0.75, b2 = -1.25;
+
+    auto x = signal<T>(K*N*L + L + 3, 0.4);
+
+    std::vector<double> y(x.size());
+    for (size_t i=0; i<x.size(); i++){
+
+        const double v = x[i] + b1*(i >= 1 ? x[i-1] : 0) + b2*(i >= 2 ? x[i-2] : 0);
+        y[i] = std::clamp<double>(std::floor(v + 0.5), -32768, 32767);
+    }
+
+    // transposed blocks
+    FixedFirCoreOrderTwo<V,N> _F(b1, b2);
+
+    std::array<V,N> v;
+
+    for (size_t k=0; k<K; k++){
+
+        for (size_t n=0; n<N; n++) v[n].load(&x[(k*N + n)*L]);
+
+        v = depermuteV(_F(permuteV(v)));
+
+        for (size_t n=0; n<N*L; n++) CHECK(v[n/L][n%L] == y[k*N*L + n]);
+    }
+
+    // vector and scalar paths, in order and carrying the state of the blocks
+    V xv;
+    xv.load(&x[K*N*L]);
+    xv = _F(xv);
+
+    for (int l=0; l<L; l++) CHECK(xv[l] == y[K*N*L + l]);
+
+    for (size_t i=K*N*L + L; i<x.size(); i++) CHECK(_F(x[i]) == y[i]);
+}
+
+
+TEST_CASE("fixed fir order two saturates Q31:"){
+
+    using V = Vec8i;
+    constexpr static int L = V::size();
+    constexpr static size_t N = L;
+    using T = int32_t;
+
+    std::vector<T> x(N*L, 0x7fffffff);
+    x[0] = -0x7fffffff;
+
+    FixedFirCoreOrderTwo<V,N,30,fixed::Round::truncate> _F(1.0, 1.0);
+
+    std::array<V,N> v;
+    for (size_t n=0; n<N; n++) v[n].load(&x[n*L]);
+
+    v = depermuteV(_F(permuteV(v)));
+
+    CHECK(v[0][0] == -0x7fffffff);
+    CHECK(v[0][1] == 0);
+    CHECK(v[0][2] == 0x7fffffff);
+    for (size_t n=3; n<N*L; n++) CHECK(v[n/L][n%L] == 0x7fffffff); // 3x full scale
+
+    // scalar path at full scale, the sum exceeds the sample type but not the wide one
+    CHECK(_F(T(0x7fffffff)) == 0x7fffffff);
+    CHECK(_F(T(-0x7fffffff-1)) == 0x7ffffffe);
+    CHECK(_F(T(-0x7fffffff-1)) == -0x7fffffff-1);
+}
+
+
+TEST_CASE("fixed fir order two Q31 - taps beyond int32:"){
+
+    using V = Vec8i;
+    constexpr static int L = V::size();
+    constexpr static size_t N = L;
+    constexpr static size_t K = 4;
+    using T = int32_t;
+
+    // b1 = 2 in Q30 is 2^31: the 64-bit multiply instead of vpmuldq, exact as the taps are
+    CHECK(!fixed::narrow_range(fixed::quantize<V,30>(2.0)));
+    CHECK(fixed::narrow_range(fixed::quantize<V,30>(1.5)));
+
+    // 4x gain at DC, below full scale
+    auto x = signal<T>(K*N*L, 0.1);
+
+    FixedFirCoreOrderTwo<V,N> _F(2.0, 1.0);
+
+    std::array<V,N> v;
+
+    for (size_t k=0; k<K; k++){
+
+        for (size_t n=0; n<N; n++) v[n].load(&x[(k*N + n)*L]);
+
+        v = depermuteV(_F(permuteV(v)));
+
+        for (size_t n=0; n<N*L; n++){
+
+            const size_t i = k*N*L + n;
+            CHECK(v[n/L][n%L] == int64_t(x[i]) + 2*(i >= 1 ? int64_t(x[i-1]) : 0) + (i >= 2 ? x[i-2] : 0));
+        }
+    }
+}
+
+
+TEST_CASE_TEMPLATE("fixed block filtering - bounded error:", V, Vec16s, Vec8i){
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+    constexpr static size_t vector_size = 64*L + 5;
+
+    // DC gain of 2.3, peak output about half of full scale
+    const double b1 = 0.5, b2 = 0.25, a1 = 1.1, a2 = -0.6;
+
+    auto x = signal<T>(vector_size, 0.1);
+    auto ref = reference(x, b1, b2, a1, a2);
+
+    std::vector<T> y(vector_size), yt(vector_size);
+
+    // in two chunks, the state carries over
+    FixedBlockFiltering<V> _F(b1, b2, a1, a2);
+    auto d_last = _F(x.begin(), x.begin() + 3*L + 1, y.begin());
+    d_last = _F(x.begin() + 3*L + 1, x.end(), d_last);
+
+    CHECK(d_last == y.end());
+
+    FixedBlockFiltering<V,fixed::frac_bits<V>-1,fixed::Round::truncate> _Ft(b1, b2, a1, a2);
+    _Ft(x.begin(), x.end(), yt.begin());
+
+    // a few LSB: output rounding and coefficient quantization, fed back through the recursion
+    for (size_t r=0; r<vector_size; r++){
+
+        CHECK(std::abs(ref[r] - y[r]) <= 4);
+        CHECK(std::abs(ref[r] - yt[r]) <= 4);
+    }
+}
+
+
+// b1 = 2 puts the responses beyond int32 in Q30, the 64-bit products of Q31 run instead of vpmuldq
+TEST_CASE("fixed block filtering Q31 - responses beyond int32:"){
+
+    using V = Vec8i;
+    using T = int32_t;
+    constexpr static int L = V::size();
+    constexpr static size_t vector_size = 64*L + 5;
+
+    const double b1 = 2, b2 = 1, a1 = 1.1, a2 = -0.6;
+
+    // DC gain of 8, peak output about 0.6 of full scale
+    auto x = signal<T>(vector_size, 0.05);
+    auto ref = reference(x, b1, b2, a1, a2);
+
+    std::vector<T> y(vector_size);
+    FixedBlockFiltering<V> _F(b1, b2, a1, a2);
+    _F(x.begin(), x.end(), y.begin());
+
+    for (size_t r=0; r<vector_size; r++) CHECK(std::abs(ref[r] - y[r]) <= 4);
+}
+
+
+TEST_CASE_TEMPLATE("fixed block filtering - clipping:", V, Vec16s, Vec8i){
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+    constexpr static size_t vector_size = 64*L + 5;
+    constexpr static size_t chunk = 2*L + 3;
+
+    const double b1 = 0.5, b2 = 0.25, a1 = 1.1, a2 = -0.6;
+
+    // peak output about 2.2x full scale, within the 4x of the wide sums
+    auto x = signal<T>(vector_size, 0.4);
+    auto ref = reference(x, b1, b2, a1, a2);
+
+    // chunks of two vectors and three samples, so the scalar path also runs where the output clips
+    std::vector<T> y(vector_size);
+    FixedBlockFiltering<V> _F(b1, b2, a1, a2);
+
+    for (size_t k=0; k<vector_size; k+=chunk){
+
+        const size_t e = std::min(k + chunk, vector_size);
+        _F(x.begin() + k, x.begin() + e, y.begin() + k);
+    }
+
+    size_t clipped = 0;
+
+    // the recursion doesn't see the clipping: the saturated reference, to quantization errors of the larger signal
+    for (size_t r=0; r<vector_size; r++){
+
+        const double lim = std::clamp<double>(ref[r], std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+
+        CHECK(std::abs(lim - y[r]) <= 8);
+        clipped += (y[r] == std::numeric_limits<T>::max() || y[r] == std::numeric_limits<T>::min());
+    }
+
+    CHECK(clipped > 0);
+}
+
+
+TEST_CASE_TEMPLATE("fixed section - int in, int out:", V, Vec16s, Vec8i){
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int L = V::size();
+    constexpr static size_t N = L;
+    constexpr static size_t vector_size = 40*N*L + 3*L + 5;
+
+    const double b1 = 0.5, b2 = 0.25, a1 = 1.1, a2 = -0.6;
+
+    // the numerator stays below full scale
+    auto x = signal<T>(vector_size, 0.2);
+    auto ref = reference(x, b1, b2, a1, a2);
+
+    FixedSectionOrderTwo<V,N> _F(b1, b2, a1, a2);
+
+    // blocks, vector and scalar remainders, in place and in chunks that don't align with the blocks
+    for (size_t k=0; k<vector_size; k+=1000) _F.process(std::span<T>(x.data() + k, std::min<size_t>(1000, vector_size - k)));
+
+    // two roundings per output, the FIR and the recursion
+    for (size_t r=0; r<vector_size; r++){
+
+        const double lim = std::clamp<double>(ref[r], std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+        CHECK(std::abs(lim - x[r]) <= 8);
+    }
+}
+
+TEST_SUITE_END();
+
+#endif // doctest
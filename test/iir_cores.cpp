@@ -5,6 +5,7 @@
 #include "../include/permute.h"
 #include <numeric>
 #include <array>
+#include <cmath>
 
 
 
@@ -177,372 +178,631 @@ TEST_CASE("block filtering V16:"){
 }
 
 
-// TEST_CASE("multi-block V4:"){
+TEST_CASE("multi-block V4:"){
 
-//     using V = Vec4f;
-//     constexpr int L = V::size();
-//     constexpr int N = L;
-//     using T = float;
+    using V = Vec4f;
+    constexpr int L = V::size();
+    constexpr int N = L;
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
 
-//     std::array<T,N*L> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,N*L> data_out=data;
+    std::array<T,N*L> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,N*L> data_out=data;
 
-//     std::array<V,N> in,out,in_T,out_T;
-//     for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+    std::array<V,N> in,out,in_T,out_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
 
-//     IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
 
-//     for (int n=0;n<N*L;n++){
+    for (int n=0;n<N*L;n++){
 
-//         if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//         else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
-//         else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
-//     }
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
 
-//     in_T = permuteV(in);
-//     out_T = I(in_T);
-//     out = depermuteV(out_T);
+    in_T = permuteV(in);
+    out_T = I(in_T);
+    out = depermuteV(out_T);
     
-//     std::array<T,N*L> res;
-//     for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
-// }
+    for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
+}
 
 
-// TEST_CASE("multi-block V8:"){
+TEST_CASE("multi-block V8:"){
 
-//     using V = Vec8f;
-//     constexpr int L = V::size();
-//     constexpr int N = L;
-//     using T = float;
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = L;
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
 
-//     std::array<T,N*L> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,N*L> data_out=data;
+    std::array<T,N*L> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,N*L> data_out=data;
 
-//     std::array<V,N> in,out,in_T,out_T;
-//     for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+    std::array<V,N> in,out,in_T,out_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
 
-//     IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
 
-//     for (int n=0;n<N*L;n++){
+    for (int n=0;n<N*L;n++){
 
-//         if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//         else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
-//         else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
-//     }
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
 
-//     in_T = permuteV(in);
-//     out_T = I(in_T);
-//     out = depermuteV(out_T);
+    in_T = permuteV(in);
+    out_T = I(in_T);
+    out = depermuteV(out_T);
     
-//     std::array<T,N*L> res;
-//     for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
-// }
+    for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
+}
 
 
-// TEST_CASE("multi-block V16:"){
+TEST_CASE("multi-block V16:"){
 
-//     using V = Vec16f;
-//     constexpr int L = V::size();
-//     constexpr int N = L;
-//     using T = float;
+    using V = Vec16f;
+    constexpr int L = V::size();
+    constexpr int N = L;
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
 
-//     std::array<T,N*L> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,N*L> data_out=data;
+    std::array<T,N*L> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,N*L> data_out=data;
 
-//     std::array<V,N> in,out,in_T,out_T;
-//     for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+    std::array<V,N> in,out,in_T,out_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
 
-//     IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
 
-//     for (int n=0;n<N*L;n++){
+    for (int n=0;n<N*L;n++){
 
-//         if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//         else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
-//         else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
-//     }
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
 
-//     in_T = permuteV(in);
-//     out_T = I(in_T);
-//     out = depermuteV(out_T);
+    in_T = permuteV(in);
+    out_T = I(in_T);
+    out = depermuteV(out_T);
     
-//     std::array<T,N*L> res;
-//     for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
-// }
+    for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
+}
 
 
 
-// TEST_CASE("multi-block - block size 2L:"){
+TEST_CASE("multi-block - block size 2L:"){
 
-//     using V = Vec8f;
-//     constexpr int L = V::size();
-//     constexpr int N = 2*L;
-//     using T = float;
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 2*L;
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
 
-//     std::array<T,N*L> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,N*L> data_out=data;
+    std::array<T,N*L> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,N*L> data_out=data;
 
-//     std::array<V,N> in,out,in_T,out_T;
-//     for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+    std::array<V,N> in,out,in_T,out_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
 
-//     IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
 
-//     for (int n=0;n<N*L;n++){
+    for (int n=0;n<N*L;n++){
 
-//         if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//         else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
-//         else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
-//     }
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
 
-//     in_T = permuteV(in);
-//     out_T = I(in_T);
-//     out = depermuteV(out_T);
+    in_T = permuteV(in);
+    out_T = I(in_T);
+    out = depermuteV(out_T);
     
-//     std::array<T,N*L> res;
-//     for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
-// }
+    for (auto r=0; r<N*L; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
+}
 
 
 
-// TEST_CASE("multi-block - streaming:"){
+TEST_CASE("multi-block - streaming:"){
 
-//     using V = Vec8f;
-//     constexpr int L = V::size();
-//     constexpr int N = 2*L; // 16
-//     constexpr int vector_size = 1024;
-//     constexpr int K = vector_size/L;
-//     using T = float;
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 2*L; // 16
+    constexpr int vector_size = 1024;
+    constexpr int K = vector_size/L;
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-//     std::array<T,vector_size> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,vector_size> data_out;
+    std::array<T,vector_size> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,vector_size> data_out;
 
-//     for (int n=0;n<vector_size;n++){
+    for (int n=0;n<vector_size;n++){
 
-//         if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//         else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
-//         else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
-//     }
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
 
-//     IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
 
-//     std::array<V,K> in_total,out_total;
-//     for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
-
-//     std::array<V,N> in,in_T,out_T,out;
-
-//     for (int i=0;i<K/N;i++){
-//         for (int j=0;j<N;j++){
-//             in[j] = in_total[j+i*N];
-//         }
-//         in_T = permuteV(in);
-//         out_T = I(in_T);
-//         out = depermuteV(out_T);
-//         for (int l=0;l<N;l++){
-//             out_total[l+i*N] = out[l];
-//         }
-//     }
+    std::array<V,K> in_total,out_total;
+    for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
+
+    std::array<V,N> in,in_T,out_T,out;
+
+    for (int i=0;i<K/N;i++){
+        for (int j=0;j<N;j++){
+            in[j] = in_total[j+i*N];
+        }
+        in_T = permuteV(in);
+        out_T = I(in_T);
+        out = depermuteV(out_T);
+        for (int l=0;l<N;l++){
+            out_total[l+i*N] = out[l];
+        }
+    }
 
-//     std::array<T,vector_size> res;
-//     for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
+    std::array<T,vector_size> res;
+    for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
-// }
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
+}
 
 
 
-// TEST_CASE("4th order multi-block - streaming:"){
+TEST_CASE("4th order multi-block - streaming:"){
 
-//     using V = Vec8f;
-//     constexpr int L = V::size();
-//     constexpr int N = 2*L; // 16
-//     constexpr int vector_size = 1024;
-//     constexpr int K = vector_size/L;
-//     constexpr int M = 2; // 4th order
-//     using T = float;
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 2*L; // 16
+    constexpr int vector_size = 1024;
+    constexpr int K = vector_size/L;
+    constexpr int M = 2; // 4th order
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-//     std::array<T,vector_size> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,vector_size> data_out=data,tmp;
+    std::array<T,vector_size> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,vector_size> data_out=data,tmp;
 
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
-//     IirCoreOrderTwo<V,N> I1(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I2(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I1(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I2(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
 
-//     std::array<V,K> in_total,out_total;
-//     for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
+    std::array<V,K> in_total,out_total;
+    for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
 
-//     std::array<V,N> in,in_T,out_T,out;
+    std::array<V,N> in,in_T,out_T,out;
 
-//     for (int i=0;i<K/N;i++){
-//         for (int j=0;j<N;j++){
-//             in[j] = in_total[j+i*N];
-//         }
-//         in_T = permuteV(in);
-//         out_T = I2(I1(in_T));
-//         out = depermuteV(out_T);
-//         for (int l=0;l<N;l++){
-//             out_total[l+i*N] = out[l];
-//         }
-//     }
+    for (int i=0;i<K/N;i++){
+        for (int j=0;j<N;j++){
+            in[j] = in_total[j+i*N];
+        }
+        in_T = permuteV(in);
+        out_T = I2(I1(in_T));
+        out = depermuteV(out_T);
+        for (int l=0;l<N;l++){
+            out_total[l+i*N] = out[l];
+        }
+    }
 
-//     std::array<T,vector_size> res;
-//     for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
+    std::array<T,vector_size> res;
+    for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
-// }
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
+}
 
 
 
-// TEST_CASE("8th order multi-block - streaming:"){
+TEST_CASE("8th order multi-block - streaming:"){
 
-//     using V = Vec8f;
-//     constexpr int L = V::size();
-//     constexpr int N = 2*L; // 16
-//     constexpr int vector_size = 1024*16;
-//     constexpr int K = vector_size/L;
-//     constexpr int M = 4; // 8th order
-//     using T = float;
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 2*L; // 16
+    constexpr int vector_size = 1024*16;
+    constexpr int K = vector_size/L;
+    constexpr int M = 4; // 8th order
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-//     std::array<T,vector_size> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,vector_size> data_out=data,tmp;
+    std::array<T,vector_size> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,vector_size> data_out=data,tmp;
 
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
-//     IirCoreOrderTwo<V,N> I1(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I2(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I3(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I4(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-
-//     std::array<V,K> in_total,out_total;
-//     for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
-
-//     std::array<V,N> in,in_T,out_T,out;
-
-//     for (int i=0;i<K/N;i++){
-//         for (int j=0;j<N;j++){
-//             in[j] = in_total[j+i*N];
-//         }
-//         in_T = permuteV(in);
-//         out_T = I4(I3(I2(I1(in_T))));
-//         out = depermuteV(out_T);
-//         for (int l=0;l<N;l++){
-//             out_total[l+i*N] = out[l];
-//         }
-//     }
+    IirCoreOrderTwo<V,N> I1(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I2(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I3(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I4(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+
+    std::array<V,K> in_total,out_total;
+    for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
+
+    std::array<V,N> in,in_T,out_T,out;
+
+    for (int i=0;i<K/N;i++){
+        for (int j=0;j<N;j++){
+            in[j] = in_total[j+i*N];
+        }
+        in_T = permuteV(in);
+        out_T = I4(I3(I2(I1(in_T))));
+        out = depermuteV(out_T);
+        for (int l=0;l<N;l++){
+            out_total[l+i*N] = out[l];
+        }
+    }
 
-//     std::array<T,vector_size> res;
-//     for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
+    std::array<T,vector_size> res;
+    for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
-// }
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]).epsilon(1e-4)); // float rounding accumulates across sections
+}
 
 
-// TEST_CASE("16th order multi-block - streaming:"){
+TEST_CASE("16th order multi-block - streaming:"){
 
-//     using V = Vec8f;
-//     constexpr int L = V::size();
-//     constexpr int N = 2*L; // 16
-//     constexpr int vector_size = 1024*8;
-//     constexpr int K = vector_size/L;
-//     constexpr int M = 8; // 8th order
-//     using T = float;
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 2*L; // 16
+    constexpr int vector_size = 1024*8;
+    constexpr int K = vector_size/L;
+    constexpr int M = 8; // 8th order
+    using T = float;
 
-//     float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
 
-//     std::array<T,vector_size> data{0};
-//     data[0] = 1; // pass an impulse response 
-//     std::array<T,vector_size> data_out=data,tmp;
+    std::array<T,vector_size> data{0};
+    data[0] = 1; // pass an impulse response 
+    std::array<T,vector_size> data_out=data,tmp;
 
-//     for (int round=0;round<M;round++){
-//         for (int n=0;n<vector_size;n++){
+    for (int round=0;round<M;round++){
+        for (int n=0;n<vector_size;n++){
 
-//             if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
-//             else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
-//             else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
-//         }
-//         data_out = tmp;
-//     }
+            if (n == 0) tmp[0] = data_out[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+            else if (n == 1) tmp[1] = data_out[1] + b2*xi1 + b1*data_out[0] + a2*yi1 + a1*tmp[0];
+            else tmp[n] = data_out[n] + b2*data_out[n-2] + b1*data_out[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+        }
+        data_out = tmp;
+    }
 
-//     IirCoreOrderTwo<V,N> I1(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I2(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I3(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I4(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I5(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I6(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I7(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-//     IirCoreOrderTwo<V,N> I8(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
-
-//     std::array<V,K> in_total,out_total;
-//     for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
-
-//     std::array<V,N> in,in_T,out_T,out;
-
-//     for (int i=0;i<K/N;i++){
-//         for (int j=0;j<N;j++){
-//             in[j] = in_total[j+i*N];
-//         }
-//         in_T = permuteV(in);
-//         out_T = I8(I7(I6(I5(I4(I3(I2(I1(in_T))))))));
-//         out = depermuteV(out_T);
-//         for (int l=0;l<N;l++){
-//             out_total[l+i*N] = out[l];
-//         }
-//     }
+    IirCoreOrderTwo<V,N> I1(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I2(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I3(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I4(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I5(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I6(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I7(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+    IirCoreOrderTwo<V,N> I8(b1,b2,a1,a2,xi1,xi2,yi1,yi2); // test first constructor
+
+    std::array<V,K> in_total,out_total;
+    for (auto n=0; n<K; n++) in_total[n].load(&data[n*L]);
+
+    std::array<V,N> in,in_T,out_T,out;
+
+    for (int i=0;i<K/N;i++){
+        for (int j=0;j<N;j++){
+            in[j] = in_total[j+i*N];
+        }
+        in_T = permuteV(in);
+        out_T = I8(I7(I6(I5(I4(I3(I2(I1(in_T))))))));
+        out = depermuteV(out_T);
+        for (int l=0;l<N;l++){
+            out_total[l+i*N] = out[l];
+        }
+    }
 
-//     std::array<T,vector_size> res;
-//     for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
+    std::array<T,vector_size> res;
+    for (auto n=0; n<K; n++) out_total[n].store(&res[n*L]);       
     
-//     for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]));
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(res[r]).epsilon(1e-4)); // float rounding accumulates across sections
 
-// }
+}
+
+
+
+TEST_CASE_TEMPLATE("multi-block in place - same as operator():", A, algo::CR, algo::PH, algo::Block, algo::CR_T){
+
+    using V = Vec16f;
+    constexpr int L = V::size();
+    constexpr int N = 4*L;
+    constexpr int K = 3*N; // three steps, the state carries over
+    using T = float;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,K*L> data;
+    std::iota(data.begin(), data.end(), 0);
+
+    IirCoreOrderTwo<V,N,A> I1(b1,b2,a1,a2,xi1,xi2,yi1,yi2);
+    IirCoreOrderTwo<V,N,A> I2(b1,b2,a1,a2,xi1,xi2,yi1,yi2);
+
+    std::array<V,N> in,out;
+
+    for (int i=0;i<K/N;i++){
+
+        for (int n=0;n<N;n++) in[n].load(&data[(i*N + n)*L]);
+        if constexpr (A::transposed) in = permuteV(in);
+
+        out = I1(in);
+        I2.apply(in);
+
+        for (int n=0;n<N;n++) 
+            for (int l=0;l<L;l++) CHECK(out[n][l] == doctest::Approx(in[n][l]));
+    }
+}
+
+
+
+TEST_CASE_TEMPLATE("first order section - every algorithm and path:", A, algo::CR, algo::PH, algo::Block, algo::CR_T, algo::PH_T){
+
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 3*L;
+    constexpr int K = 4*N*L + 2*L + 3; // multi-block, block and scalar steps
+    using T = float;
+
+    float b1 = 0.7, a1 = 0.9, xi1 = 0.3, yi1 = -1.2;
+
+    std::array<T,K> data,data_out,out;
+    for (int n=0; n<K; n++) data[n] = std::sin(0.1f*n) + 0.05f*(n % 11);
+
+    for (int n=0; n<K; n++){
+
+        if (n == 0) data_out[0] = data[0] + b1*xi1 + a1*yi1;
+        else data_out[n] = data[n] + b1*data[n-1] + a1*data_out[n-1];
+    }
+
+    // the row layout of IirCoreOrderTwo, b2, a2, xi2 and yi2 are ignored
+    T taps[5] = {1,b1,99,a1,99}; 
+    T inits[4] = {xi1,99,yi1,99};
+
+    IirCoreOrderOne<V,N,A> I(taps,inits);
+
+    std::array<V,N> x;
+    int k = 0;
+
+    for (; k+N*L<=K; k+=N*L){
+
+        for (int n=0;n<N;n++) x[n].load(&data[k + n*L]);
+        if constexpr (A::transposed) x = permuteV(x);
+
+        I.apply(x);
+
+        if constexpr (A::transposed) x = depermuteV(x);
+        for (int n=0;n<N;n++) x[n].store(&out[k + n*L]);
+    }
+
+    I.template sync<std::array<V,N>>();
+
+    for (; k+L<=K; k+=L){
+
+        V v;
+        v.load(&data[k]);
+        I(v).store(&out[k]);
+    }
+
+    I.template sync<V>();
+
+    for (; k<K; k++) out[k] = I(data[k]);
+
+    for (int r=0; r<K; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4));
+
+    auto s = I.template state<T>();
+    CHECK(s[0] == data[K-1]);
+    CHECK(s[1] == 0);
+    CHECK(s[2] == doctest::Approx(data_out[K-1]).epsilon(1e-4));
+    CHECK(s[3] == 0);
+}
+
+
+
+TEST_CASE_TEMPLATE("order K section - every path:", C, std::integral_constant<size_t,3>, std::integral_constant<size_t,5>, std::integral_constant<size_t,8>){
+
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 2*L;
+    constexpr size_t K = C::value;
+    constexpr int S = 4*N*L + 2*L + 3; // multi-block, block and scalar steps
+    using T = double; // the reference runs in double, the comparison in float
+    using A = std::conditional_t<K == 5, algo::PH_T, algo::PH>;
+
+    // poles at 0.6 e^(+-i...) and on the real axis, all inside the unit circle
+    double den[K+1] = {1}, poles[K] = {0.6, -0.5, 0.3, -0.7, 0.2, 0.4, -0.3, 0.5};
+    for (size_t k=0; k<K; k++) for (size_t i=k+1; i>=1; i--) den[i] -= poles[k]*den[i-1];
+
+    float taps[2*K+1], inits[2*K];
+    taps[0] = 1;
+    for (size_t k=1; k<=K; k++){ taps[k] = 0.5f/k; taps[K+k] = -den[k];}
+    for (size_t k=0; k<2*K; k++) inits[k] = 0.25f*(k % 5) - 0.5f;
+
+    std::array<float,S> data,out;
+    std::array<T,S> data_out;
+    for (int n=0; n<S; n++) data[n] = std::sin(0.1f*n) + 0.05f*(n % 11);
+
+    for (int n=0; n<S; n++){
+
+        T y = data[n];
+        for (size_t k=1; k<=K; k++){
+
+            y += taps[k]*(n >= int(k) ? T(data[n-k]) : T(inits[k-n-1]));
+            y += taps[K+k]*(n >= int(k) ? data_out[n-k] : T(inits[K+k-n-1]));
+        }
+        data_out[n] = y;
+    }
+
+    IirCoreOrderK<V,N,K,A> I(taps,inits);
+
+    std::array<V,N> x;
+    int k = 0;
+
+    for (; k+N*L<=S; k+=N*L){
+
+        for (int n=0;n<N;n++) x[n].load(&data[k + n*L]);
+        if constexpr (A::transposed) x = permuteV(x);
+
+        I.apply(x);
+
+        if constexpr (A::transposed) x = depermuteV(x);
+        for (int n=0;n<N;n++) x[n].store(&out[k + n*L]);
+    }
+
+    I.template sync<std::array<V,N>>();
+
+    for (; k+L<=S; k+=L){
+
+        V v;
+        v.load(&data[k]);
+        I(v).store(&out[k]);
+    }
+
+    I.template sync<V>();
+
+    for (; k<S; k++) out[k] = I(data[k]);
+
+    for (int r=0; r<S; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-3));
+
+    auto st = I.template state<float>();
+    CHECK(st[0] == data[S-1]);
+    CHECK(st[K] == doctest::Approx(data_out[S-1]).epsilon(1e-3));
+}
+
+
+
+TEST_CASE("order K section - four biquads multiplied out:"){
+
+    using V = Vec8f;
+    constexpr int L = V::size();
+    constexpr int N = 2*L;
+    constexpr int M = 4;
+    constexpr int S = 8*N*L;
+    using T = float;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2},{1,0.2,0.1,-0.6,-0.3},{1,2,1,0.9,-0.4}};
+    T zero[2*2*M] = {};
+
+    auto taps = order_k_from_biquads(coefs);
+
+    std::array<T,S> data,out;
+    std::array<double,S> data_out;
+    for (int n=0; n<S; n++) data[n] = std::sin(0.1f*n) + 0.05f*(n % 11);
+
+    // the cascade from rest
+    std::copy(data.begin(), data.end(), data_out.begin());
+    for (int m=0; m<M; m++){
+
+        double xi1 = 0, xi2 = 0, yi1 = 0, yi2 = 0;
+
+        for (auto& v : data_out){
+
+            double y = v + coefs[m][1]*xi1 + coefs[m][2]*xi2 + coefs[m][3]*yi1 + coefs[m][4]*yi2;
+            xi2 = xi1; xi1 = v;
+            yi2 = yi1; yi1 = y;
+            v = y;
+        }
+    }
+
+    IirCoreOrderK<V,N,2*M> I(taps.data(),zero);
+
+    std::array<V,N> x;
+
+    for (int k=0; k<S; k+=N*L){
+
+        for (int n=0;n<N;n++) x[n].load(&data[k + n*L]);
+
+        x = permuteV(x);
+        I.apply(x);
+        x = depermuteV(x);
+
+        for (int n=0;n<N;n++) x[n].store(&out[k + n*L]);
+    }
+
+    for (int r=0; r<S; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-3));
+}
+
+
+// the section holds only the sub-cores of its algorithm: the sum of those, plus alignment padding of at most one
+// line per member, bounds it for any VCL build
+TEST_CASE_TEMPLATE("section size - only the sub-cores of the algorithm:", V, Vec8f, Vec16f){
+
+    using T = float;
+    constexpr static size_t N = 64;
+    constexpr static size_t pad = 64;
+
+    constexpr size_t common = sizeof(BlockFiltering<V>) + 2*sizeof(Shift<V>) + 4*sizeof(T);
+
+    constexpr size_t cr = sizeof(FirCoreOrderTwo<V,N>) + sizeof(CyclicReduction<V,N>) + common;
+    constexpr size_t ph = sizeof(FirCoreOrderTwo<V,N>) + sizeof(PartSolutionV<V,N>) + sizeof(HomoSolutionV<V,N>) + common;
+
+    CHECK(sizeof(IirCoreOrderTwo<V,N,algo::CR>) <= cr + 5*pad);
+    CHECK(sizeof(IirCoreOrderTwo<V,N,algo::PH>) <= ph + 6*pad);
+    CHECK(sizeof(IirCoreOrderTwo<V,N,algo::Block>) <= common + 4*pad);
+
+    // CR no longer carries the PH sub-cores, which the old layout added to cr
+    CHECK(sizeof(IirCoreOrderTwo<V,N,algo::CR>) < cr + sizeof(PartSolutionV<V,N>) + sizeof(HomoSolutionV<V,N>));
+
+    // nor the elimination scratch: N = 2^6, _h2/_h1, a shift register, _H as a window of 2L scalars, 2 x 6 + 4 x 6 + 2 x 5 scalars
+    constexpr int L = V::size();
+    CHECK(sizeof(CyclicReduction<V,N>) <= (2 + 1)*sizeof(V) + (2*L + 46)*sizeof(T) + 4*pad);
+}
+
+
+// a cascade of 16 sections and the block of N*L samples it works on stay within a 32 KB L1D
+TEST_CASE_TEMPLATE("section size - the cascade fits L1:", V, Vec8f, Vec16f){
+
+    constexpr static size_t M = 16;
+    constexpr static size_t N = 64;
+    constexpr static size_t tile = N*V::size()*sizeof(float);
+
+    CHECK(M*sizeof(IirCoreOrderTwo<V,N,algo::CR>) <= 32*1024 - tile);
+    CHECK(M*sizeof(IirCoreOrderTwo<V,N,algo::Block>) <= 32*1024 - tile);
+}
 
 
 
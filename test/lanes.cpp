@@ -0,0 +1,110 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/lanes.h"
+#include "../include/shift_reg.h"
+#include <numeric>
+#include <array>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("lanes:");
+
+
+template<typename V> V iota_v(){
+
+    using T = decltype(std::declval<V>().extract(0));
+    std::array<T,V::size()> data;
+    std::iota(data.begin(), data.end(), 1);
+
+    V v;
+    v.load(&data[0]);
+    return v;
+}
+
+template<typename V> void check_equal(const V a, const V b){
+
+    for (int l=0; l<V::size(); l++) CHECK(a[l] == b[l]);
+}
+
+
+TEST_CASE("lane lists V4:"){
+
+    using V = Vec4f;
+    V a = iota_v<V>(), b = a*10;
+
+    check_equal(permute_lanes<shift_up>(a), permute4<-1,0,1,2>(a));
+    check_equal(permute_lanes<shift_up_dup>(a), permute4<0,0,1,2>(a));
+    check_equal(blend_lanes<shift_in>(a, 7.f), blend4<4,0,1,2>(a, V(7.f)));
+    check_equal(blend_lanes<shift_down_in>(a, 7.f), blend4<1,2,3,4>(a, V(7.f)));
+    check_equal(blend_lanes<first_in>(a, b), blend4<4,0,0,0>(a, b));
+
+    check_equal(permute_lanes<rd_broadcast,1>(a), permute4<-1,0,-1,2>(a));
+    check_equal(permute_lanes<rd_broadcast,2>(a), permute4<-1,-1,1,1>(a));
+
+    check_equal(permute_lanes<rd_factor,0>(a), permute4<0,-1,-1,-1>(a));
+    check_equal(permute_lanes<rd_factor,1>(a), permute4<-1,0,-1,0>(a));
+    check_equal(permute_lanes<rd_factor,2>(a), permute4<-1,-1,0,1>(a));
+}
+
+
+TEST_CASE("lane lists V8:"){
+
+    using V = Vec8f;
+    V a = iota_v<V>(), b = a*10;
+
+    check_equal(permute_lanes<shift_up>(a), permute8<-1,0,1,2,3,4,5,6>(a));
+    check_equal(blend_lanes<shift_in>(a, b), blend8<8,0,1,2,3,4,5,6>(a, b));
+    check_equal(blend_lanes<shift_down_in>(a, b), blend8<1,2,3,4,5,6,7,8>(a, b));
+    check_equal(permute_lanes<pair_swap>(a), permute8<1,0,3,2,5,4,7,6>(a));
+
+    check_equal(permute_lanes<rd_broadcast,1>(a), permute8<-1,0,-1,2,-1,4,-1,6>(a));
+    check_equal(permute_lanes<rd_broadcast,2>(a), permute8<-1,-1,1,1,-1,-1,5,5>(a));
+    check_equal(permute_lanes<rd_broadcast,3>(a), permute8<-1,-1,-1,-1,3,3,3,3>(a));
+
+    check_equal(permute_lanes<rd_factor,2>(a), permute8<-1,-1,0,1,-1,-1,0,1>(a));
+    check_equal(permute_lanes<rd_factor,3>(a), permute8<-1,-1,-1,-1,0,1,2,3>(a));
+}
+
+
+TEST_CASE("lane lists V16:"){
+
+    using V = Vec16f;
+    V a = iota_v<V>();
+
+    check_equal(permute_lanes<rd_broadcast,3>(a), permute16<-1,-1,-1,-1,3,3,3,3,-1,-1,-1,-1,11,11,11,11>(a));
+    check_equal(permute_lanes<rd_broadcast,4>(a), permute16<-1,-1,-1,-1,-1,-1,-1,-1,7,7,7,7,7,7,7,7>(a));
+    check_equal(permute_lanes<rd_factor,4>(a), permute16<-1,-1,-1,-1,-1,-1,-1,-1,0,1,2,3,4,5,6,7>(a));
+}
+
+
+TEST_CASE("lane lists V2d:"){
+
+    using V = Vec2d;
+    V a = iota_v<V>();
+
+    check_equal(permute_lanes<shift_up>(a), permute2<-1,0>(a));
+    check_equal(permute_lanes<shift_up_dup>(a), permute2<0,0>(a));
+    check_equal(blend_lanes<shift_in>(a, 7.), blend2<2,0>(a, V(7.)));
+    check_equal(permute_lanes<rd_factor,0>(a), permute2<0,-1>(a));
+    check_equal(permute_lanes<rd_factor,1>(a), permute2<-1,0>(a));
+}
+
+
+TEST_CASE_TEMPLATE("toeplitz window:", V, Vec4f, Vec8f, Vec16f, Vec4d){
+
+    V h = iota_v<V>();
+    Toeplitz<V> H(h);
+
+    // column l is h shifted up l times
+    for (int l=0; l<V::size(); l++){
+
+        check_equal(H[l], h);
+        h = permute_lanes<shift_up>(h);
+    }
+}
+
+
+TEST_SUITE_END();
+
+#endif
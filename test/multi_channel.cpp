@@ -0,0 +1,209 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/multi_channel.h"
+#include <numeric>
+#include <vector>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+
+
+TEST_SUITE_BEGIN("multi-channel:");
+
+
+// scalar reference, one channel at a time, x[c*S + t]
+template<typename T,size_t M>
+std::vector<T> reference(const std::vector<T>& data, const size_t C, const T (&coefs)[M][5], const T (&inits)[M][4]){
+
+    const size_t S = data.size()/C;
+    std::vector<T> data_out = data, tmp(S);
+
+    for (size_t c=0;c<C;c++){
+        for (size_t m=0;m<M;m++){
+
+            T b1 = coefs[m][1], b2 = coefs[m][2], a1 = coefs[m][3], a2 = coefs[m][4];
+            T xi1 = inits[m][0], xi2 = inits[m][1], yi1 = inits[m][2], yi2 = inits[m][3];
+            T* x = &data_out[c*S];
+
+            for (size_t n=0;n<S;n++){
+
+                if (n == 0) tmp[0] = x[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+                else if (n == 1) tmp[1] = x[1] + b2*xi1 + b1*x[0] + a2*yi1 + a1*tmp[0];
+                else tmp[n] = x[n] + b2*x[n-2] + b1*x[n-1] + a2*tmp[n-2] + a1*tmp[n-1];
+            }
+            std::copy(tmp.begin(), tmp.end(), x);
+        }
+    }
+
+    return data_out;
+}
+
+
+TEST_CASE("channel-major 4th order V8:"){
+
+    using V = Vec8f;
+    using T = float;
+    constexpr static int M = 2;
+    constexpr static size_t C = 20; // last group is partial
+    constexpr static size_t S = 1027; // last tile is partial
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    std::vector<T> data(C*S,0), out(C*S);
+    for (size_t c=0;c<C;c++) data[c*S + c] = 1+c; // shifted impulse per channel
+
+    auto data_out = reference(data, C, coefs, inits);
+
+    MultiChannelFilter<V,M> _F(coefs, inits, C);
+    auto d_last = _F.channel_major(data.begin(), data.end(), out.begin());
+
+    CHECK(d_last == out.end());
+
+    for (size_t r=0; r<C*S; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("channel-major streaming V16:"){
+
+    using V = Vec16f;
+    using T = float;
+    constexpr static int M = 1;
+    constexpr static size_t C = 64;
+    constexpr static size_t S = 512;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
+
+    std::vector<T> data(C*S), out(C*S);
+    std::iota(data.begin(), data.end(), 0);
+    for (auto& d : data) d = std::fmod(d, 97.f);
+
+    auto data_out = reference(data, C, coefs, inits);
+
+    // two frames of S/2 samples per channel, re-packed channel-major
+    MultiChannelFilter<V,M> _F(coefs, inits, C);
+    std::vector<T> frame(C*S/2), frame_out(C*S/2);
+
+    for (size_t f=0;f<2;f++){
+
+        for (size_t c=0;c<C;c++) 
+            std::copy_n(&data[c*S + f*S/2], S/2, &frame[c*S/2]);
+
+        _F.channel_major(frame.begin(), frame.end(), frame_out.begin());
+
+        for (size_t c=0;c<C;c++) 
+            std::copy_n(&frame_out[c*S/2], S/2, &out[c*S + f*S/2]);
+    }
+
+    for (size_t r=0; r<C*S; r++) CHECK(data_out[r] == doctest::Approx(out[r]));
+}
+
+
+TEST_CASE("interleaved 8th order V4:"){
+
+    using V = Vec4f;
+    using T = float;
+    constexpr static int M = 4;
+    constexpr static size_t C = 7; // last group is partial
+    constexpr static size_t S = 1000;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    std::vector<T> data(C*S,0), in(C*S), out(C*S);
+    for (size_t c=0;c<C;c++) data[c*S + 3*c] = 1; // shifted impulse per channel
+
+    auto data_out = reference(data, C, coefs, inits);
+
+    // interleave, x[t*C + c]
+    for (size_t c=0;c<C;c++) 
+        for (size_t t=0;t<S;t++) in[t*C + c] = data[c*S + t];
+
+    MultiChannelFilter<V,M> _F(coefs, inits, C);
+    _F.interleaved(in.begin(), in.end(), out.begin());
+
+    for (size_t c=0;c<C;c++) 
+        for (size_t t=0;t<S;t++) CHECK(data_out[c*S + t] == doctest::Approx(out[t*C + c]));
+}
+
+
+TEST_CASE("software prefetch leaves the result unchanged V8:"){
+
+    using V = Vec8f;
+    using T = float;
+    constexpr static int M = 2;
+    constexpr static size_t C = 11;
+    constexpr static size_t S = 777;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2}};
+    T inits[M][4] = {{2,1,-3,-5},{0.5,0,1,-1}};
+
+    std::vector<T> data(C*S), in(C*S), out(C*S);
+    for (size_t n=0;n<C*S;n++) data[n] = std::sin(0.01f*n);
+
+    auto data_out = reference(data, C, coefs, inits);
+
+    MultiChannelFilter<V,M> _F(coefs, inits, C);
+    _F.prefetch(64);
+    CHECK(_F.prefetch() == 64);
+
+    _F.channel_major(data.begin(), data.end(), out.begin());
+
+    for (size_t n=0;n<C*S;n++) CHECK(data_out[n] == doctest::Approx(out[n]).epsilon(1e-4));
+
+    for (size_t c=0;c<C;c++) 
+        for (size_t t=0;t<S;t++) in[t*C + c] = data[c*S + t];
+
+    MultiChannelFilter<V,M> _G(coefs, inits, C);
+    _G.prefetch(64);
+    _G.interleaved(in.begin(), in.end(), out.begin());
+
+    for (size_t c=0;c<C;c++) 
+        for (size_t t=0;t<S;t++) CHECK(data_out[c*S + t] == doctest::Approx(out[t*C + c]).epsilon(1e-4));
+}
+
+
+TEST_CASE("zero channels and partial frames:"){
+
+    using V = Vec8f;
+    using T = float;
+    constexpr static int M = 1;
+    constexpr static size_t C = 3;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5}};
+    T inits[M][4] = {};
+
+    CHECK_THROWS_AS((MultiChannelFilter<V,M>(coefs, inits, 0)), std::invalid_argument);
+
+    // two whole frames and one sample of a third, which is left as it is
+    std::vector<T> in(2*C + 1, 1), out(2*C + 1, -7);
+
+    MultiChannelFilter<V,M> _F(coefs, inits, C);
+    auto d_last = _F.interleaved(in.begin(), in.end(), out.begin());
+
+    CHECK(d_last == out.begin() + 2*C);
+    CHECK(out[2*C] == -7);
+}
+
+
+
+TEST_SUITE_END();
+
+#endif // doctest
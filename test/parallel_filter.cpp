@@ -0,0 +1,130 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/parallel_filter.h"
+#include <vector>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("parallel filter:");
+
+
+// the cascade, from rest without inits
+template<typename T,size_t M>
+std::vector<double> reference(const std::vector<T>& x, const T (&coefs)[M][5], const T (&inits)[M][4] = {}){
+
+    std::vector<double> y(x.begin(), x.end());
+
+    for (size_t m=0; m<M; m++){
+
+        double xi1 = inits[m][0], xi2 = inits[m][1], yi1 = inits[m][2], yi2 = inits[m][3];
+
+        for (auto& v : y){
+
+            double out = v + coefs[m][1]*xi1 + coefs[m][2]*xi2 + coefs[m][3]*yi1 + coefs[m][4]*yi2;
+            xi2 = xi1; xi1 = v;
+            yi2 = yi1; yi1 = out;
+            v = out;
+        }
+    }
+
+    return y;
+}
+
+
+TEST_CASE_TEMPLATE("6th order parallel form - every algorithm:", A, algo::CR, algo::PH, algo::Block){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static size_t N = 2*L;
+    constexpr static size_t M = 3;
+    constexpr static size_t vector_size = 40*N*L + 3*L + 5;
+    using T = float;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2},{1,0.2,0.1,-0.6,-0.3}};
+
+    std::vector<T> in(vector_size), out(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = std::sin(T(0.01)*n) + T(0.1)*(n % 7);
+
+    auto ref = reference(in, coefs);
+
+    ParallelFilter<V,M,N,A> _F(coefs);
+
+    // in two chunks, the state carries over
+    auto d_last = _F(in.begin(), in.begin() + 1000, out.begin());
+    d_last = _F(in.begin() + 1000, in.end(), d_last);
+
+    CHECK(d_last == out.end());
+
+    for (size_t r=0; r<vector_size; r++) CHECK(ref[r] == doctest::Approx(out[r]).epsilon(1e-4));
+}
+
+
+TEST_CASE("8th order parallel form V4d:"){
+
+    using V = Vec4d;
+    constexpr static int L = V::size();
+    constexpr static size_t N = 16;
+    constexpr static size_t M = 4;
+    constexpr static size_t vector_size = 16*N*L + L + 1;
+    using T = double;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2},{1,0.2,0.1,-0.6,-0.3},{1,2,1,0.9,-0.4}};
+
+    std::vector<T> in(vector_size, 0), out(vector_size);
+    in[0] = 1; // impulse response
+
+    auto ref = reference(in, coefs);
+
+    ParallelFilter<V,M,N> _F(coefs);
+    _F.process(std::span<T>(in));
+
+    for (size_t r=0; r<vector_size; r++) CHECK(ref[r] == doctest::Approx(in[r]).epsilon(1e-10));
+}
+
+TEST_CASE_TEMPLATE("6th order parallel form - inits of the cascade:", A, algo::CR, algo::PH, algo::Block){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static size_t N = 2*L;
+    constexpr static size_t M = 3;
+    constexpr static size_t vector_size = 10*N*L + 3*L + 5;
+    using T = float;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2},{1,0.2,0.1,-0.6,-0.3}};
+    T inits[M][4] = {{2,1,-3,-5},{0.5,0,1,-1},{-1,0.25,0.5,2}};
+
+    std::vector<T> in(vector_size), out(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = std::sin(T(0.01)*n) + T(0.1)*(n % 7);
+
+    auto ref = reference(in, coefs, inits);
+
+    ParallelFilter<V,M,N,A> _F(coefs, inits);
+    _F(in.begin(), in.end(), out.begin());
+
+    for (size_t r=0; r<vector_size; r++) CHECK(ref[r] == doctest::Approx(out[r]).epsilon(1e-4));
+}
+
+
+TEST_CASE("repeated sections are rejected:"){
+
+    using V = Vec8f;
+    constexpr static size_t M = 2;
+    using T = float;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,1,2,0.4,-0.5}};
+
+    CHECK_THROWS_AS((ParallelFilter<V,M,2*V::size()>(coefs)), std::invalid_argument);
+
+    // one shared pole is enough: (1 - 0.5 z^-1)(1 - 0.25 z^-1) and (1 - 0.5 z^-1)(1 + 0.25 z^-1)
+    T shared[M][5] = {{1,0,0,0.75,-0.125},{1,0,0,0.25,0.125}};
+
+    CHECK_THROWS_AS((ParallelFilter<V,M,2*V::size()>(shared)), std::invalid_argument);
+}
+
+
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -172,6 +172,60 @@ TEST_CASE("encapsulated (de)permute V16:"){
 
 }
 
+TEST_CASE("encapsulated (de)permute V2d:"){
+
+    using V = Vec2d;
+    constexpr int L = V::size();
+    constexpr int N = 8*L;
+    using T = double;
+
+    std::array<T,N*L> data;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<V,N> in;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+
+    std::array<V,N> out_T,out;
+    out_T = permuteV(in);
+    out = depermuteV(out_T);
+
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);   
+
+    for (auto c=0; c<N; c++)
+        for (auto r=0; r<L; r++) CHECK(res[L*c+r] == L*c+r);
+
+}
+
+
+
+TEST_CASE("encapsulated (de)permute V8d:"){
+
+    using V = Vec8d;
+    constexpr int L = V::size();
+    constexpr int N = 2*L;
+    using T = double;
+
+    std::array<T,N*L> data;
+    std::iota(data.begin(), data.end(), 0);
+
+    std::array<V,N> in;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+
+    std::array<V,N> out_T,out;
+    out_T = permuteV(in);
+    out = depermuteV(out_T);
+
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);   
+
+    for (auto c=0; c<N; c++)
+        for (auto r=0; r<L; r++) CHECK(res[L*c+r] == L*c+r);
+
+}
+
+
+
 TEST_SUITE_END();
 
 #endif
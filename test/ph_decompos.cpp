@@ -301,6 +301,94 @@ TEST_CASE("homogeneous solutions V16:"){
 
 
 
+TEST_CASE("homogeneous solutions V2d:"){
+
+    using V = Vec2d;
+    constexpr int L = V::size();
+    constexpr int N = L;
+    using T = double;
+
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,N*L> data;
+    std::iota(data.begin(), data.end(), 0);
+
+    FirCoreOrderTwo<V,N> F(b1,b2,xi1,xi2); 
+    PartSolutionV<V,N> PS(a1,a2); // test first constructor
+    HomoSolutionV<V,N> HS(a1,a2,yi1,yi2); // test first constructor
+
+    std::array<V,N> in,in_T,out,out_T,tmp1_T,tmp2_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+
+    std::array<T,N*L> y;
+
+    for (int n=0;n<N*L;n++){
+
+        if (n == 0) y[0] = data[0] + b1*xi1 + b2*xi2 + a1*yi1 + a2*yi2;
+        else if (n == 1) y[1] = data[1] + b1*data[0] + b2*xi1 + a1*y[0] + a2*yi1;
+        else y[n] = data[n] + b1*data[n-1] + b2*data[n-2] + a1*y[n-1] + a2*y[n-2];
+    }
+
+    in_T = permuteV(in);
+    tmp1_T = F(in_T);
+    tmp2_T = PS(tmp1_T);
+    out_T = HS(tmp2_T);
+    out = depermuteV(out_T);
+
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    
+    for (auto r=0; r<N*L; r++) CHECK(y[r] == doctest::Approx(res[r]).epsilon(1e-12));
+
+
+}
+
+
+
+TEST_CASE("homogeneous solutions V4d:"){
+
+    using V = Vec4d;
+    constexpr int L = V::size();
+    constexpr int N = L;
+    using T = double;
+
+    double b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::array<T,N*L> data;
+    std::iota(data.begin(), data.end(), 0);
+
+    FirCoreOrderTwo<V,N> F(b1,b2,xi1,xi2); 
+    PartSolutionV<V,N> PS(a1,a2); // test first constructor
+    HomoSolutionV<V,N> HS(a1,a2,yi1,yi2); // test first constructor
+
+    std::array<V,N> in,in_T,out,out_T,tmp1_T,tmp2_T;
+    for (auto n=0; n<N; n++) in[n].load(&data[n*L]);
+
+    std::array<T,N*L> y;
+
+    for (int n=0;n<N*L;n++){
+
+        if (n == 0) y[0] = data[0] + b1*xi1 + b2*xi2 + a1*yi1 + a2*yi2;
+        else if (n == 1) y[1] = data[1] + b1*data[0] + b2*xi1 + a1*y[0] + a2*yi1;
+        else y[n] = data[n] + b1*data[n-1] + b2*data[n-2] + a1*y[n-1] + a2*y[n-2];
+    }
+
+    in_T = permuteV(in);
+    tmp1_T = F(in_T);
+    tmp2_T = PS(tmp1_T);
+    out_T = HS(tmp2_T);
+    out = depermuteV(out_T);
+
+    std::array<T,N*L> res;
+    for (auto n=0; n<N; n++) out[n].store(&res[n*L]);       
+    
+    for (auto r=0; r<N*L; r++) CHECK(y[r] == doctest::Approx(res[r]).epsilon(1e-12));
+
+
+}
+
+
+
 TEST_SUITE_END();
 
 
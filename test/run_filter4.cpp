@@ -12,95 +12,12 @@
 #include <cstdlib>
 #include "../src/vcl/vectorclass.h"
 #include "../include/filter.h"
+#include "../include/dynamic_filter.h"
+#include "../include/filtfilt.h"
+#include "../include/parallel_filter.h"
 #include <cmath>
 #include <fstream>
-
-static inline uint64_t rdtsc_begin() {
-    unsigned hi, lo;
-    asm volatile(
-        "cpuid\n\t"        // full serialize
-        "rdtsc\n\t"        // read TSC
-        : "=a"(lo), "=d"(hi)
-        :: "rbx", "rcx"
-    );
-    return (uint64_t(hi) << 32) | lo;
-}
-
-static inline uint64_t rdtsc_end() {
-    unsigned hi, lo;
-    asm volatile(
-        "rdtscp\n\t"       // read TSC + serialize into ECX
-        "mov %%edx, %0\n\t"
-        "mov %%eax, %1\n\t"
-        "cpuid\n\t"        // serialize again
-        : "=r"(hi), "=r"(lo)
-        :: "rax", "rbx", "rcx", "rdx"
-    );
-    return (uint64_t(hi) << 32) | lo;
-}
-
-// PMC Core Cycle Counter class
-class CoreCycleCounter {
-private:
-    int fd;
-    bool enabled;
-    
-public:
-    CoreCycleCounter() : fd(-1), enabled(false) {
-        struct perf_event_attr pe;
-        memset(&pe, 0, sizeof(pe));
-        pe.type = PERF_TYPE_HARDWARE;
-        pe.config = PERF_COUNT_HW_CPU_CYCLES;
-        pe.size = sizeof(pe);
-        pe.disabled = 1;
-        pe.exclude_kernel = 1;
-        pe.exclude_hv = 1;
-        pe.exclude_idle = 1;
-        
-        fd = syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
-        if (fd == -1) {
-            perror("perf_event_open failed - you may need to run: echo 0 | sudo tee /proc/sys/kernel/perf_event_paranoid");
-            std::cerr << "Note: Core cycle counting will be disabled, using TSC only\n";
-            enabled = false;
-        } else {
-            enabled = true;
-            std::cout << "PMC Core cycle counter initialized successfully\n";
-        }
-    }
-    
-    void start() { 
-        if (enabled) {
-            ioctl(fd, PERF_EVENT_IOC_RESET, 0); 
-            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); 
-        }
-    }
-    
-    void stop() { 
-        if (enabled) {
-            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); 
-        }
-    }
-    
-    uint64_t read() {
-        if (!enabled) return 0;
-        
-        uint64_t count;
-        ssize_t result = ::read(fd, &count, sizeof(count));
-        if (result != sizeof(count)) {
-            perror("Failed to read PMC counter");
-            return 0;
-        }
-        return count;
-    }
-    
-    bool is_enabled() const { return enabled; }
-    
-    ~CoreCycleCounter() { 
-        if (fd != -1) {
-            close(fd); 
-        }
-    }
-};
+#include "timing.h"
 
 // Enhanced CPU frequency detection using run_filter2.cpp calibration method
 double detect_cpu_frequency() {
@@ -184,13 +101,25 @@ double detect_cpu_frequency() {
     return avg_frequency;
 }
 
+// vector type, e.g. -DFILTER_VEC=Vec4d to measure double precision
+#ifdef FILTER_VEC
+using V = FILTER_VEC;
+#else
 using V = Vec8f;
+#endif
 using T = decltype(std::declval<V>().extract(0));
 constexpr int L = V::size();
 constexpr static int N = 32;
 constexpr static int M = 8;
 
+// the last section first order (IirCoreOrderOne), filter order 2M-1; e.g. -DFILTER_ODD=1
+#ifndef FILTER_ODD
+#define FILTER_ODD 0
+#endif
+constexpr bool Odd = FILTER_ODD;
+
 constexpr T b1 = 2, b2 = 1, a1 = 1.3, a2 = -0.4;
+constexpr T c1 = 0.5; // pole of the first-order section
 constexpr T xi1 = 2, xi2 = 1, yi1 = -3, yi2 = -5;
 
 constexpr T inits[M][4] = {{xi1,xi2,yi1,yi2},
@@ -209,15 +138,119 @@ constexpr T coefs[M][5] = {{1,b1,b2,a1,a2},
                            {1,b1,b2,a1,a2},
                            {1,b1,b2,a1,a2},
                            {1,b1,b2,a1,a2},
-                           {1,b1,b2,a1,a2}
+                           {1,b1,Odd ? 0 : b2,Odd ? c1 : a1,Odd ? 0 : a2}
                           };
 
-// match your large-array workload
+// match your large-array workload, -DLARGE_ARRAY for buffers far beyond the LLC (256 MB each in float)
+#ifdef LARGE_ARRAY
+constexpr static int vector_size = 1 << 26;
+#else
 constexpr static int vector_size = 131072;
+#endif
+
+// Filter execution mode: 0 operator(), 1 pipelined(), 2 DynamicFilter (runtime M),
+// 3 filter_inplace() on the input buffer alone (every run refilters the previous output),
+// 4 streamed() with non-temporal stores, compare it with 0 under -DLARGE_ARRAY,
+// 5 zero-phase FiltFilt (forward and reversed pass, compare it with twice 0),
+// 6 the cascade as M/4 direct order-8 sections (IirCoreOrderK, PH/RD) against M biquads in 0,
+// 7 ParallelFilter, the M sections in parallel form (poles moved apart, see make_filter); e.g. -DFILTER_MODE=1
+#ifndef FILTER_MODE
+#define FILTER_MODE 0
+#endif
+constexpr const char* mode_names[8] = {"operator()","pipelined()","DynamicFilter","filter_inplace()","streamed()","FiltFilt","IirCoreOrderK","ParallelFilter"};
+
+// multi-block algorithm: algo::CR, algo::PH, algo::Block, algo::CR_T, algo::PH_T; e.g. -DFILTER_ALGO=algo::PH
+#ifndef FILTER_ALGO
+#define FILTER_ALGO algo::CR
+#endif
+using A = FILTER_ALGO;
+
+// software prefetch distance in samples for the Filter block loops, 0 off; e.g. -DFILTER_PREFETCH=4096
+#ifndef FILTER_PREFETCH
+#define FILTER_PREFETCH 0
+#endif
+
+// mode 6: every four biquads multiplied out into one section of order 8, from rest; vector_size is a multiple of N*L
+struct OrderKFilter{
+
+    using Core = IirCoreOrderK<V,N,8>;
+
+    static_assert(M == 8 && !Odd);
+    Series<Core,Core> _S;
+
+    OrderKFilter(){
+
+        T lo[4][5], hi[4][5];
+        for (int m=0; m<4; m++) for (int i=0; i<5; i++){ lo[m][i] = coefs[m][i]; hi[m][i] = coefs[4+m][i];}
+
+        const auto taps_lo = order_k_from_biquads(lo), taps_hi = order_k_from_biquads(hi);
+        const T zero[16] = {};
+
+        _S = Series<Core,Core>(Core(taps_lo.data(), zero), Core(taps_hi.data(), zero));
+    }
+
+    template<typename It, typename Ot>
+    inline void operator()(It first, It last, Ot d_first){
+
+        std::array<V,N> x;
+
+        for (; last - first >= N*L; first += N*L, d_first += N*L){
+
+            for (int n=0; n<N; n++) x[n].load(&*(first + n*L));
+
+            x = permuteV(x);
+            _S.apply(x);
+            x = depermuteV(x);
+
+            for (int n=0; n<N; n++) x[n].store(&*(d_first + n*L));
+        }
+    }
+
+    inline void prefetch(const size_t){}
+};
+
+// the same cascade, with M fixed at compile time (Series) or only known at run time
+inline auto make_filter(){
+    if constexpr (FILTER_MODE == 2){
+        std::vector<std::array<T,5>> c(M);
+        std::vector<std::array<T,4>> s(M);
+        for (int m = 0; m < M; ++m){
+            std::copy(coefs[m], coefs[m] + 5, c[m].begin());
+            std::copy(inits[m], inits[m] + 4, s[m].begin());
+        }
+        return DynamicFilter<V,N,A>(c, s);
+    }
+    else if constexpr (FILTER_MODE == 5) return FiltFilt<V,M,N,A,Odd>(coefs);
+    else if constexpr (FILTER_MODE == 6) return OrderKFilter();
+    else if constexpr (FILTER_MODE == 7){
+        // identical sections share their poles and have no parallel form, the cost doesn't depend on the values
+        T c[M][5];
+        for (int m = 0; m < M; ++m){
+            std::copy(coefs[m], coefs[m] + 5, c[m]);
+            c[m][4] = a2 - T(0.02)*m;
+        }
+        return ParallelFilter<V,M,N,A>(c, inits);
+    }
+    else return Filter<V,M,N,A,Odd>(coefs, inits);
+}
+
+template<typename F, typename It, typename Ot>
+__attribute__((always_inline))
+inline void run_filter(F& _F, It first, It last, Ot d_first){
+    if constexpr (FILTER_MODE == 1) _F.pipelined(first, last, d_first);
+    else if constexpr (FILTER_MODE == 3) _F.filter_inplace(std::span<T>(&*first, last - first));
+    else if constexpr (FILTER_MODE == 4) _F.streamed(&*first, &*first + (last - first), &*d_first);
+    else _F(first, last, d_first);
+}
 
 // number of runs to average
+#ifdef LARGE_ARRAY
+constexpr int ITERS  = 20;
+constexpr int WARMUP = 2;
+#else
 constexpr int ITERS  = 10000;
 constexpr int WARMUP = 200;
+#endif
 
 // scalar measurement cps V8
 constexpr T measured_cps[4][1] = {27.614,31.990,47.428,87.669}; // filter order: 2,4,8,16, block size: 8,16,32,64,128
@@ -243,13 +276,15 @@ int main(){
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
     //–– Build filter & data
-    alignas(64) std::array<T, vector_size> in{0}, out;
-    in[0] = 1;
-    auto _F = Filter<V,M,N>(coefs, inits);
+    // static, the large-array buffers do not fit on the stack
+    alignas(64) static std::array<T, vector_size> in, out;
+    fill_workload(in.begin(), in.end());
+    auto _F = make_filter();
+    if constexpr (FILTER_MODE != 2) _F.prefetch(FILTER_PREFETCH);
 
     //–– Warm up caches/TLB/branch predictor
     for(int i = 0; i < WARMUP; ++i)
-        _F(in.begin(), in.end(), out.begin());
+        run_filter(_F, in.begin(), in.end(), out.begin());
 
     //–– Measure empty loop overhead
     double loop_overhead_ns = 0;
@@ -282,7 +317,7 @@ int main(){
     core_counter.start();
     
     for(int i = 0; i < ITERS; ++i)
-        _F(in.begin(), in.end(), out.begin());
+        run_filter(_F, in.begin(), in.end(), out.begin());
     
     core_counter.stop();
     uint64_t tsc_end = rdtsc_end();
@@ -320,8 +355,12 @@ int main(){
     std::cout << "=== CONFIGURATION ===\n";
     std::cout << "vector_size = " << vector_size 
             << ", block_size = " << N
-            << ", IIR filter order = " << 2*M
-            << ", iterations = " << ITERS << "\n\n";
+            << ", IIR filter order = " << 2*M - Odd
+            << ", iterations = " << ITERS 
+            << ", mode = " << mode_names[FILTER_MODE] 
+            << ", algorithm = " << (FILTER_MODE == 6 ? algo::PH::name : A::name)
+            << ", prefetch = " << FILTER_PREFETCH
+            << ", lanes = " << L << " x " << (sizeof(T) == 8 ? "double" : "float") << "\n\n";
 
     std::cout << "=== TIMING RESULTS ===\n";
     std::cout << "Wall-clock timing:\n"
@@ -0,0 +1,90 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/threaded_filter.h"
+#include <numeric>
+#include <vector>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+
+
+TEST_SUITE_BEGIN("threaded filter:");
+
+
+TEST_CASE("second order threaded filter V8:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 2*L;
+    constexpr static int vector_size = (1 << 18) + 3*L + 5;
+    using T = float;
+    constexpr static int M = 1;
+
+    float b2 = 2, b1 = 1, a1 = 0.4, a2 = 0.5, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::vector<T> data(vector_size), out(vector_size);
+    std::iota(data.begin(), data.end(), 0);
+    for (auto& d : data) d = std::fmod(d, 101.f) - 50;
+
+    std::vector<T> data_out(vector_size);
+
+    for (int n=0;n<vector_size;n++){
+
+        if (n == 0) data_out[0] = data[0] + b2*xi2 + b1*xi1 + a2*yi2 + a1*yi1;
+        else if (n == 1) data_out[1] = data[1] + b2*xi1 + b1*data[0] + a2*yi1 + a1*data_out[0];
+        else data_out[n] = data[n] + b2*data[n-2] + b1*data[n-1] + a2*data_out[n-2] + a1*data_out[n-1];
+    }
+
+    T coefs[M][5] = {1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2};
+
+    auto _F = ThreadedFilter<V,M,N>(coefs, inits, 4);
+
+    _F(data.begin(),data.end(),out.begin());  
+    
+    for (auto r=0; r<vector_size; r++) CHECK(data_out[r] == doctest::Approx(out[r]).epsilon(1e-4));
+}
+
+
+TEST_CASE("8th order threaded filter - streaming:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static int N = 4*L;
+    constexpr static int vector_size = 1 << 18;
+    using T = float;
+    constexpr static int M = 4;
+
+    float b2 = 2, b1 = 1, a1 = 1.3, a2 = -0.4, xi2 = 1, xi1 = 2, yi1 = -3, yi2 = -5;
+
+    std::vector<T> data(2*vector_size), out(2*vector_size), ref(2*vector_size);
+    std::iota(data.begin(), data.end(), 0);
+    for (auto& d : data) d = std::fmod(d, 37.f) - 18;
+
+    T coefs[M][5] = {1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2,
+                     1,b1,b2,a1,a2}; 
+    T inits[M][4] = {xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2,
+                     xi1,xi2,yi1,yi2};
+
+    // single-threaded Filter as the reference
+    auto _G = Filter<V,M,N>(coefs, inits);
+    _G(data.begin(),data.end(),ref.begin());
+
+    // two calls, the boundary state of the first carries over to the second
+    auto _F = ThreadedFilter<V,M,N>(coefs, inits, 3);
+    _F(data.begin(),data.begin()+vector_size,out.begin());
+    _F(data.begin()+vector_size,data.end(),out.begin()+vector_size);
+
+    for (auto r=0; r<2*vector_size; r++) CHECK(ref[r] == doctest::Approx(out[r]).epsilon(1e-4));
+}
+
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,112 @@
+#ifndef TIMING_H
+#define TIMING_H 1
+
+// Serialized TSC reads and a perf_event core cycle counter, shared by the benchmarks and the autotuner.
+
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+
+// The input of the timed runs, a sum of two sines that never decays. After an impulse the output of a stable
+// filter decays into subnormals, and every operation on those takes a microcode assist on x86, which would be
+// timed instead of the filter.
+template<typename It>
+static inline void fill_workload(It first, It last) {
+    for (size_t n = 0; first != last; ++first, ++n) *first = std::sin(0.01*n) + 0.5*std::sin(0.37*n);
+}
+
+static inline uint64_t rdtsc_begin() {
+    unsigned hi, lo;
+    asm volatile(
+        "cpuid\n\t"        // full serialize
+        "rdtsc\n\t"        // read TSC
+        : "=a"(lo), "=d"(hi)
+        :: "rbx", "rcx"
+    );
+    return (uint64_t(hi) << 32) | lo;
+}
+
+static inline uint64_t rdtsc_end() {
+    unsigned hi, lo;
+    asm volatile(
+        "rdtscp\n\t"       // read TSC + serialize into ECX
+        "mov %%edx, %0\n\t"
+        "mov %%eax, %1\n\t"
+        "cpuid\n\t"        // serialize again
+        : "=r"(hi), "=r"(lo)
+        :: "rax", "rbx", "rcx", "rdx"
+    );
+    return (uint64_t(hi) << 32) | lo;
+}
+
+// PMC Core Cycle Counter class
+class CoreCycleCounter {
+private:
+    int fd;
+    bool enabled;
+    
+public:
+    CoreCycleCounter() : fd(-1), enabled(false) {
+        struct perf_event_attr pe;
+        memset(&pe, 0, sizeof(pe));
+        pe.type = PERF_TYPE_HARDWARE;
+        pe.config = PERF_COUNT_HW_CPU_CYCLES;
+        pe.size = sizeof(pe);
+        pe.disabled = 1;
+        pe.exclude_kernel = 1;
+        pe.exclude_hv = 1;
+        pe.exclude_idle = 1;
+        
+        fd = syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+        if (fd == -1) {
+            perror("perf_event_open failed - you may need to run: echo 0 | sudo tee /proc/sys/kernel/perf_event_paranoid");
+            std::cerr << "Note: Core cycle counting will be disabled, using TSC only\n";
+            enabled = false;
+        } else {
+            enabled = true;
+            std::cout << "PMC Core cycle counter initialized successfully\n";
+        }
+    }
+    
+    void start() { 
+        if (enabled) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0); 
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); 
+        }
+    }
+    
+    void stop() { 
+        if (enabled) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); 
+        }
+    }
+    
+    uint64_t read() {
+        if (!enabled) return 0;
+        
+        uint64_t count;
+        ssize_t result = ::read(fd, &count, sizeof(count));
+        if (result != sizeof(count)) {
+            perror("Failed to read PMC counter");
+            return 0;
+        }
+        return count;
+    }
+    
+    bool is_enabled() const { return enabled; }
+    
+    ~CoreCycleCounter() { 
+        if (fd != -1) {
+            close(fd); 
+        }
+    }
+};
+
+
+#endif // header guard
@@ -0,0 +1,156 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "../src/doctest.h"
+#include "../include/tuned_filter.h"
+#include <numeric>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+TEST_SUITE_BEGIN("tuned filter:");
+
+
+template<typename T,size_t M>
+std::vector<T> reference(const std::vector<T>& x, const T (&coefs)[M][5], const T (&inits)[M][4]){
+
+    std::vector<T> y = x;
+
+    for (size_t m=0; m<M; m++){
+
+        T xi1 = inits[m][0], xi2 = inits[m][1], yi1 = inits[m][2], yi2 = inits[m][3];
+
+        for (auto& v : y){
+
+            T out = v + coefs[m][1]*xi1 + coefs[m][2]*xi2 + coefs[m][3]*yi1 + coefs[m][4]*yi2;
+            xi2 = xi1; xi1 = v;
+            yi2 = yi1; yi1 = out;
+            v = out;
+        }
+    }
+
+    return y;
+}
+
+
+TEST_CASE("profile round trip:"){
+
+    TuningProfile p;
+    p.add({"float", 8, 4, 32, "CR", 3.5});
+    p.add({"double", 4, 4, 16, "PH-RD", 6.25});
+    p.add({"float", 8, 4, 64, "block", 3.25}); // replaces the first entry
+
+    const std::string path = "/tmp/tuned_filter_test.prof";
+    REQUIRE(p.save(path));
+
+    TuningProfile q;
+    REQUIRE(q.load(path));
+    std::remove(path.c_str());
+
+    CHECK(q.entries().size() == 2);
+
+    auto e = q.find("float", 8, 4);
+    REQUIRE(e != nullptr);
+    CHECK(e->N == 64);
+    CHECK(e->algorithm == "block");
+    CHECK(e->cps == doctest::Approx(3.25));
+
+    CHECK(q.find("float", 16, 4) == nullptr);
+    CHECK(!q.load("/tmp/does_not_exist.prof"));
+}
+
+
+TEST_CASE("every candidate is buildable from a profile V8:"){
+
+    using V = Vec8f;
+    constexpr static int L = V::size();
+    constexpr static size_t M = 2;
+    constexpr static size_t vector_size = 128*L*2 + 3*L + 5;
+    using T = float;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5},{1,-0.5,0.25,0.3,-0.2}};
+    T inits[M][4] = {{2,1,-3,-5},{0.5,0,1,-1}};
+
+    std::vector<T> in(vector_size), out(vector_size);
+    for (size_t n=0; n<vector_size; n++) in[n] = std::sin(T(0.01)*n) + T(0.1)*(n % 7);
+
+    auto ref = reference(in, coefs, inits);
+
+    size_t count = 0;
+
+    tuning::for_each_candidate<V>([&]<size_t N,typename A>(){
+
+        TuningProfile p;
+        p.add({"float", L, M, N, A::name, 1.0});
+
+        TunedFilter<V,M,tuning::Config<N,A>> _F(coefs, inits, p);
+
+        CHECK(_F.block_size() == N);
+        CHECK(std::string(_F.algorithm()) == A::name);
+
+        // in two chunks, the state carries over
+        _F.process(std::span<const T>(in.data(), 1000), std::span<T>(out.data(), 1000));
+        _F.process(std::span<const T>(in.data() + 1000, vector_size - 1000), std::span<T>(out.data() + 1000, vector_size - 1000));
+
+        for (size_t r=0; r<vector_size; r++) CHECK(ref[r] == doctest::Approx(out[r]).epsilon(1e-4));
+
+        count++;
+    });
+
+    CHECK(count == 3*tuning::num_sizes<V>());
+}
+
+
+TEST_CASE("block size grid:"){
+
+    // 8, 16, 24, 32, 48, 64, 96, 128 for Vec8f
+    CHECK(tuning::num_sizes<Vec8f>() == 8);
+    CHECK(tuning::block_size<Vec8f>(2) == 24);
+    CHECK(tuning::block_size<Vec8f>(4) == 48);
+    CHECK(tuning::block_size<Vec8f>(7) == 128);
+
+    // 16, 32, 48, 64, 96, 128 for Vec16f
+    CHECK(tuning::num_sizes<Vec16f>() == 6);
+    CHECK(tuning::block_size<Vec16f>(2) == 48);
+}
+
+
+TEST_CASE("falls back without a matching entry V4d:"){
+
+    using V = Vec4d;
+    constexpr static size_t M = 1;
+    using T = double;
+
+    T coefs[M][5] = {{1,1,2,0.4,-0.5}};
+    T inits[M][4] = {{2,1,-3,-5}};
+
+    TuningProfile p;
+    p.add({"float", 4, 1, 16, "PH-RD", 1.0});   // other precision
+    p.add({"double", 4, 2, 16, "PH-RD", 1.0});  // other order
+
+    TunedFilter<V,M> _F(coefs, inits, p);
+
+    CHECK(_F.block_size() == 32);
+    CHECK(std::string(_F.algorithm()) == "CR");
+
+    TuningProfile q;
+    q.add({"double", 4, 1, 24, "CR", 1.0});     // in the grid, but not compiled in
+
+    TunedFilter<V,M,tuning::Config<24,algo::PH>,tuning::Config<64,algo::CR>> _G(coefs, inits, q);
+
+    CHECK(_G.block_size() == 32);
+
+    TuningProfile r;
+    r.add({"double", 4, 1, 64, "CR", 1.0});
+
+    TunedFilter<V,M,tuning::Config<24,algo::PH>,tuning::Config<64,algo::CR>> _H(coefs, inits, r);
+
+    CHECK(_H.block_size() == 64);
+    CHECK(std::string(_H.algorithm()) == "CR");
+}
+
+
+TEST_SUITE_END();
+
+#endif // doctest